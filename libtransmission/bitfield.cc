@@ -6,6 +6,7 @@
 #include <algorithm> // std::copy, std::fill_n, std::min, std::max
 #include <cstddef>
 #include <cstdint>
+#include <cstring> // std::memcpy
 #include <vector> // std::vector
 
 #include "libtransmission/bitfield.h"
@@ -536,13 +537,13 @@ void tr_bitfield::unset_from(tr_bitfield const& that) noexcept
 
 size_t tr_bitfield::find_first_unset(size_t begin, size_t end) const noexcept
 {
-    if (begin >= end || begin >= bit_count_)
+    end = std::min(end, bit_count_);
+
+    if (begin >= end)
     {
         return end;
     }
 
-    end = std::min(end, bit_count_);
-
     if (has_none())
     {
         return begin;
@@ -580,9 +581,28 @@ size_t tr_bitfield::find_first_unset(size_t begin, size_t end) const noexcept
         ++byte_idx;
     }
 
-    // Check whole bytes (fast path - skip bytes that are all 1s)
+    // The byte scan is clamped to the allocated prefix of flags_; the
+    // unallocated tail is handled after the loops since every bit there
+    // is implicitly unset
     size_t const last_byte = (end - 1) >> 3U;
-    while (byte_idx < std::size(flags_) && byte_idx <= last_byte)
+    size_t const n_bytes = std::min(std::size(flags_), last_byte + 1);
+
+    // Skip all-ones stretches eight bytes at a time. memcpy compiles to
+    // a single unaligned load; this is the common case when scanning a
+    // mostly-requested region.
+    while (byte_idx + sizeof(uint64_t) <= n_bytes)
+    {
+        auto word = uint64_t{};
+        std::memcpy(&word, &flags_[byte_idx], sizeof(word));
+        if (word != ~uint64_t{})
+        {
+            break;
+        }
+        byte_idx += sizeof(uint64_t);
+    }
+
+    // Check whole bytes (fast path - skip bytes that are all 1s)
+    while (byte_idx < n_bytes)
     {
         if (flags_[byte_idx] != 0xFF)
         {
@@ -600,5 +620,92 @@ size_t tr_bitfield::find_first_unset(size_t begin, size_t end) const noexcept
         ++byte_idx;
     }
 
+    // flags_ is only allocated up to the highest bit ever set, so bits at
+    // index >= std::size(flags_) * 8 are implicitly unset
+    if (size_t const alloced_bits = std::size(flags_) * 8U; alloced_bits < end)
+    {
+        return std::max(begin, alloced_bits);
+    }
+
+    return end;
+}
+
+size_t tr_bitfield::find_first_set(size_t begin, size_t end) const noexcept
+{
+    end = std::min(end, bit_count_);
+
+    if (begin >= end)
+    {
+        return end;
+    }
+
+    if (has_none())
+    {
+        return end;
+    }
+
+    if (has_all())
+    {
+        return begin;
+    }
+
+    // Check first partial byte
+    size_t byte_idx = begin >> 3U;
+    size_t const bit_in_byte = begin & 7U;
+
+    if (byte_idx < std::size(flags_))
+    {
+        // Mask out bits before 'begin' by clearing them
+        uint8_t const byte = flags_[byte_idx] & static_cast<uint8_t>(0xFF >> bit_in_byte);
+        if (byte != 0U)
+        {
+            for (size_t i = bit_in_byte; i < 8; ++i)
+            {
+                if ((byte & (0x80 >> i)) != 0)
+                {
+                    size_t const bit_pos = (byte_idx << 3) + i;
+                    return bit_pos < end ? bit_pos : end;
+                }
+            }
+        }
+        ++byte_idx;
+    }
+
+    // The byte scan is clamped to the allocated prefix of flags_, which
+    // is correct here as-is: the unallocated tail holds no set bits, so
+    // falling through to 'return end' is the right answer for it
+    size_t const last_byte = (end - 1) >> 3U;
+    size_t const n_bytes = std::min(std::size(flags_), last_byte + 1);
+
+    // Skip all-zero stretches eight bytes at a time (see find_first_unset)
+    while (byte_idx + sizeof(uint64_t) <= n_bytes)
+    {
+        auto word = uint64_t{};
+        std::memcpy(&word, &flags_[byte_idx], sizeof(word));
+        if (word != uint64_t{})
+        {
+            break;
+        }
+        byte_idx += sizeof(uint64_t);
+    }
+
+    // Check whole bytes (fast path - skip bytes that are all 0s)
+    while (byte_idx < n_bytes)
+    {
+        if (flags_[byte_idx] != 0U)
+        {
+            uint8_t const byte = flags_[byte_idx];
+            for (size_t i = 0; i < 8; ++i)
+            {
+                if ((byte & (0x80 >> i)) != 0)
+                {
+                    size_t const bit_pos = (byte_idx << 3) + i;
+                    return bit_pos < end ? bit_pos : end;
+                }
+            }
+        }
+        ++byte_idx;
+    }
+
     return end;
 }
@@ -119,9 +119,28 @@ public:
     // Clear bits that are set in 'that' (this &= ~that)
     void unset_from(tr_bitfield const& that) noexcept;
 
-    // Find first unset bit in [begin, end). Returns end if all bits are set.
+    // Find first unset bit in [begin, end), where end is clamped to
+    // size(). Returns the clamped end if every bit in the range is set.
+    // Bits past the lazily-allocated flag bytes count as unset.
     [[nodiscard]] size_t find_first_unset(size_t begin, size_t end) const noexcept;
 
+    // Find first set bit in [begin, end), where end is clamped to
+    // size(). Returns the clamped end if no bit in the range is set.
+    [[nodiscard]] size_t find_first_set(size_t begin, size_t end) const noexcept;
+
+    // Hint that the cacheline holding 'bit' will be read soon.
+    void prefetch(size_t bit) const noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        if ((bit >> 3U) < std::size(flags_))
+        {
+            __builtin_prefetch(&flags_[bit >> 3U]);
+        }
+#else
+        (void)bit;
+#endif
+    }
+
 private:
     [[nodiscard]] size_t count_flags() const noexcept;
     [[nodiscard]] size_t count_flags(size_t begin, size_t end) const noexcept;
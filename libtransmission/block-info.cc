@@ -27,4 +27,13 @@ void tr_block_info::init_sizes(uint64_t const total_size_in, uint32_t const piec
 
     remainder = total_size_ % BlockSize;
     final_block_size_ = remainder != 0U ? remainder : BlockSize;
+
+    piece_size_shift_ = 0U;
+    if ((piece_size_ & (piece_size_ - 1U)) == 0U)
+    {
+        while (uint64_t{ 1U } << (piece_size_shift_ + 1U) <= piece_size_)
+        {
+            ++piece_size_shift_;
+        }
+    }
 }
@@ -81,8 +81,12 @@ public:
         {
             loc.byte = byte_idx;
 
+            // BlockSize divides reduce to shifts at compile time; piece
+            // sizes are powers of two for every mainstream creator, so
+            // the cached shift usually avoids a runtime division too
             loc.block = static_cast<tr_block_index_t>(byte_idx / BlockSize);
-            loc.piece = static_cast<tr_piece_index_t>(byte_idx / piece_size());
+            loc.piece = static_cast<tr_piece_index_t>(
+                piece_size_shift_ != 0U ? byte_idx >> piece_size_shift_ : byte_idx / piece_size());
 
             loc.block_offset = static_cast<uint32_t>(loc.byte - (uint64_t{ loc.block } * BlockSize));
             loc.piece_offset = static_cast<uint32_t>(loc.byte - (uint64_t{ loc.piece } * piece_size()));
@@ -153,4 +157,9 @@ private:
 
     uint32_t piece_size_ = {};
     uint32_t final_piece_size_ = {};
+
+    // log2(piece_size_) when the piece size is a power of two, or 0 to
+    // fall back to division (piece sizes are always >= BlockSize, so a
+    // real shift can never be 0)
+    uint32_t piece_size_shift_ = {};
 };
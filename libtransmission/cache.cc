@@ -220,6 +220,13 @@ int Cache::flush_torrent(tr_torrent_id_t const tor_id)
         std::lower_bound(std::begin(blocks_), std::end(blocks_), std::make_pair(tor_id + 1, 0), CompareCacheBlockByKey));
 }
 
+void Cache::drop_torrent(tr_torrent_id_t const tor_id)
+{
+    blocks_.erase(
+        std::lower_bound(std::begin(blocks_), std::end(blocks_), std::make_pair(tor_id, 0), CompareCacheBlockByKey),
+        std::lower_bound(std::begin(blocks_), std::end(blocks_), std::make_pair(tor_id + 1, 0), CompareCacheBlockByKey));
+}
+
 int Cache::flush_biggest()
 {
     auto const [begin, end] = find_biggest_span(std::begin(blocks_), std::end(blocks_));
@@ -42,6 +42,9 @@ public:
     int flush_torrent(tr_torrent_id_t tor_id);
     int flush_file(tr_torrent const& tor, tr_file_index_t file);
 
+    // discard the torrent's cached blocks without writing them to disk
+    void drop_torrent(tr_torrent_id_t tor_id);
+
 private:
     using Key = std::pair<tr_torrent_id_t, tr_block_index_t>;
 
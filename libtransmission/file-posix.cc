@@ -185,10 +185,25 @@ std::optional<tr_sys_path_info> tr_sys_path_get_info(std::string_view path, int
 
     info.size = static_cast<uint64_t>(sb.st_size);
     info.last_modified_at = sb.st_mtime;
+    info.device = static_cast<uint64_t>(sb.st_dev);
 
     return info;
 }
 
+void tr_sys_path_readahead(std::string_view path)
+{
+#ifdef POSIX_FADV_WILLNEED
+    auto const szpath = tr_pathbuf{ path };
+    if (auto const fd = open(szpath, O_RDONLY); fd != -1)
+    {
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
 bool tr_sys_path_is_relative(std::string_view path)
 {
     return std::empty(path) || path.front() != '/';
@@ -76,7 +76,12 @@ constexpr bool to_bool(BOOL value) noexcept
     return value != FALSE;
 }
 
-constexpr auto stat_to_sys_path_info(DWORD attributes, DWORD size_low, DWORD size_high, FILETIME const& mtime)
+constexpr auto stat_to_sys_path_info(
+    DWORD attributes,
+    DWORD size_low,
+    DWORD size_high,
+    FILETIME const& mtime,
+    DWORD volume_serial_number = 0)
 {
     auto info = tr_sys_path_info{};
 
@@ -98,6 +103,7 @@ constexpr auto stat_to_sys_path_info(DWORD attributes, DWORD size_low, DWORD siz
     info.size |= size_low;
 
     info.last_modified_at = filetime_to_unix_time(mtime);
+    info.device = volume_serial_number;
 
     return info;
 }
@@ -332,7 +338,8 @@ std::optional<tr_sys_path_info> tr_sys_file_get_info_(tr_sys_file_t handle, tr_e
             attributes.dwFileAttributes,
             attributes.nFileSizeLow,
             attributes.nFileSizeHigh,
-            attributes.ftLastWriteTime);
+            attributes.ftLastWriteTime,
+            attributes.dwVolumeSerialNumber);
     }
 
     set_system_error(error, GetLastError());
@@ -439,6 +446,11 @@ std::optional<tr_sys_path_info> tr_sys_path_get_info(std::string_view path, int
     return {};
 }
 
+void tr_sys_path_readahead(std::string_view /*path*/)
+{
+    // no readahead hint on this platform
+}
+
 bool tr_sys_path_is_relative(std::string_view path)
 {
     /* UNC path: `\\...`. */
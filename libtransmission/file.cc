@@ -3,6 +3,7 @@
 // or any future license endorsed by Mnemosyne LLC.
 // License text can be found in the licenses/ folder.
 
+#include <algorithm>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -16,7 +17,8 @@ std::vector<std::string> tr_sys_dir_get_files(
     std::function<bool(std::string_view)> const& test,
     tr_error* error)
 {
-    if (auto const info = tr_sys_path_get_info(folder); !info || !info->isFolder())
+    auto const info = tr_sys_path_get_info(folder);
+    if (!info || !info->isFolder())
     {
         return {};
     }
@@ -28,6 +30,10 @@ std::vector<std::string> tr_sys_dir_get_files(
     }
 
     auto filenames = std::vector<std::string>{};
+    // the directory's own byte size loosely tracks its entry count
+    // (roughly 24 bytes per entry on common filesystems); use it as a
+    // reserve hint, clamped so unusual filesystems can't oversize it
+    filenames.reserve(static_cast<size_t>(std::clamp<uint64_t>(info->size / 24U, 16U, 4096U)));
     for (;;)
     {
         char const* const name = tr_sys_dir_read_name(odir, error);
@@ -89,6 +89,11 @@ struct tr_sys_path_info
     uint64_t size = {};
     time_t last_modified_at = {};
 
+    // identifies the filesystem/volume holding the path
+    // (`st_dev` on POSIX, volume serial number on Windows).
+    // 0 when unknown.
+    uint64_t device = {};
+
     [[nodiscard]] constexpr auto isFile() const noexcept
     {
         return type == TR_SYS_PATH_IS_FILE;
@@ -157,6 +162,17 @@ bool tr_sys_path_copy(char const* src_path, char const* dst_path, tr_error* erro
  */
 [[nodiscard]] std::optional<tr_sys_path_capacity> tr_sys_path_get_capacity(std::string_view path, tr_error* error = nullptr);
 
+/**
+ * @brief Hint to the OS that a file is about to be read, so it can start
+ *        paging the contents in while the caller is busy elsewhere.
+ *
+ * Best-effort: a no-op on platforms without a readahead facility, and
+ * failures are silently ignored.
+ *
+ * @param[in] path Path to file.
+ */
+void tr_sys_path_readahead(std::string_view path);
+
 /**
  * @brief Portability wrapper for `access()`.
  *
@@ -0,0 +1,55 @@
+// This file Copyright © Mnemosyne LLC.
+// It may be used under GPLv2 (SPDX: GPL-2.0-only), GPLv3 (SPDX: GPL-3.0-only),
+// or any future license endorsed by Mnemosyne LLC.
+// License text can be found in the licenses/ folder.
+
+#pragma once
+
+#ifndef __TRANSMISSION__
+#error only libtransmission should #include this header.
+#endif
+
+#include <algorithm> // std::min()
+#include <cstddef> // size_t
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace libtransmission
+{
+
+// Invoke func(begin, end) over [0, n_files) split into contiguous
+// ranges, one blocking std::async task per range, so independent
+// per-file filesystem probes overlap instead of serializing. Small
+// counts run inline; the fan-out is only worth the thread spawns when
+// each task gets a meaningful amount of work. Blocks until every range
+// is done, so func must be safe to run concurrently with itself but
+// needs no synchronization with the caller.
+template<typename RangeFunc>
+void parallel_for_file_ranges(size_t const n_files, RangeFunc const& func)
+{
+    static auto constexpr MinFilesPerTask = size_t{ 64U };
+
+    auto const n_tasks = std::min(size_t{ std::thread::hardware_concurrency() }, n_files / MinFilesPerTask);
+    if (n_tasks <= 1U)
+    {
+        func(size_t{ 0U }, n_files);
+        return;
+    }
+
+    auto tasks = std::vector<std::future<void>>{};
+    tasks.reserve(n_tasks);
+    auto const files_per_task = (n_files + n_tasks - 1U) / n_tasks;
+    for (size_t i = 0; i < n_tasks; ++i)
+    {
+        auto const begin = i * files_per_task;
+        tasks.emplace_back(std::async(std::launch::async, func, begin, std::min(begin + files_per_task, n_files)));
+    }
+
+    for (auto& task : tasks)
+    {
+        task.wait();
+    }
+}
+
+} // namespace libtransmission
@@ -5,7 +5,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <numeric>
 #include <vector>
 
 #define LIBTRANSMISSION_PEER_MODULE
@@ -15,200 +18,681 @@
 #include "libtransmission/bitfield.h"
 #include "libtransmission/peer-mgr-wishlist.h"
 
+tr_bitfield Wishlist::Mediator::wanted_and_missing_pieces() const
+{
+    auto const n_pieces = piece_count();
+    auto pieces = tr_bitfield{ n_pieces };
+
+    for (tr_piece_index_t piece = 0U; piece < n_pieces; ++piece)
+    {
+        if (client_wants_piece(piece) && !client_has_piece(piece))
+        {
+            pieces.set(piece);
+        }
+    }
+
+    return pieces;
+}
+
 class Wishlist::Impl
 {
-    struct Candidate
+    // Candidate pieces, kept as parallel arrays (struct-of-arrays):
+    // the sort and the hot scan in next() each touch only a few of the
+    // fields, so splitting them packs more candidates per cacheline
+    // than one array of wide structs would.
+    struct Candidates
     {
-        tr_piece_index_t piece;
-        tr_piece_index_t file_index;
-        tr_block_span_t block_span;
-        tr_priority_t priority;
-        bool is_in_file_tail; // tail portion of file (2% of size, capped at 20 MB) - prioritized for video playback
-        bool is_in_priority_file; // index files (IFO, BUP, index.bdmv) - prioritized for disc playback
+        static auto constexpr TailFlag = uint8_t{ 1U << 0U }; // tail portion of file (2% of size, capped at 20 MB) - prioritized for video playback
+        static auto constexpr PriorityFileFlag = uint8_t{ 1U << 1U }; // index files (IFO, BUP, index.bdmv) - prioritized for disc playback
+
+        std::vector<tr_piece_index_t> pieces;
+        std::vector<tr_piece_index_t> file_indexes;
+        std::vector<tr_block_span_t> block_spans;
+        std::vector<tr_priority_t> priorities;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> n_unrequested; // count of span blocks not in requested_
+
+        [[nodiscard]] auto size() const noexcept
+        {
+            return std::size(pieces);
+        }
+
+        [[nodiscard]] auto empty() const noexcept
+        {
+            return std::empty(pieces);
+        }
+
+        void clear()
+        {
+            pieces.clear();
+            file_indexes.clear();
+            block_spans.clear();
+            priorities.clear();
+            flags.clear();
+            n_unrequested.clear();
+        }
+
+        void reserve(size_t const n)
+        {
+            pieces.reserve(n);
+            file_indexes.reserve(n);
+            block_spans.reserve(n);
+            priorities.reserve(n);
+            flags.reserve(n);
+            n_unrequested.reserve(n);
+        }
+
+        void push_back(
+            tr_piece_index_t const piece,
+            tr_piece_index_t const file_index,
+            tr_block_span_t const block_span,
+            tr_priority_t const priority,
+            bool const is_in_file_tail,
+            bool const is_in_priority_file,
+            uint32_t const n_unrequested_in)
+        {
+            pieces.push_back(piece);
+            file_indexes.push_back(file_index);
+            block_spans.push_back(block_span);
+            priorities.push_back(priority);
+            flags.push_back(
+                static_cast<uint8_t>(
+                    (is_in_file_tail ? TailFlag : uint8_t{}) | (is_in_priority_file ? PriorityFileFlag : uint8_t{})));
+            n_unrequested.push_back(n_unrequested_in);
+        }
+
+        void move_to(size_t const src, size_t const tgt)
+        {
+            pieces[tgt] = pieces[src];
+            file_indexes[tgt] = file_indexes[src];
+            block_spans[tgt] = block_spans[src];
+            priorities[tgt] = priorities[src];
+            flags[tgt] = flags[src];
+            n_unrequested[tgt] = n_unrequested[src];
+        }
+
+        void resize(size_t const n)
+        {
+            pieces.resize(n);
+            file_indexes.resize(n);
+            block_spans.resize(n);
+            priorities.resize(n);
+            flags.resize(n);
+            n_unrequested.resize(n);
+        }
+
+        void erase(size_t const idx)
+        {
+            pieces.erase(std::begin(pieces) + idx);
+            file_indexes.erase(std::begin(file_indexes) + idx);
+            block_spans.erase(std::begin(block_spans) + idx);
+            priorities.erase(std::begin(priorities) + idx);
+            flags.erase(std::begin(flags) + idx);
+            n_unrequested.erase(std::begin(n_unrequested) + idx);
+        }
 
-        // Sort by: priority (high first), file index, priority files (true first), file tail (true first), piece index
-        [[nodiscard]] constexpr auto sort_key() const noexcept
+        // Sort by: priority (high first), file index, priority files (true first), file tail (true first), piece index.
+        // The priority field is handled separately by bucketing; the rest
+        // of the key is packed into one uint64_t so each comparison in
+        // the per-bucket sort is a single integer compare instead of a
+        // field-by-field tuple walk. Piece and flag bits share the low
+        // word: 32-bit file index, the two inverted flag bits, then the
+        // piece index (pieces fit comfortably in 30 bits).
+        [[nodiscard]] auto sub_sort_key(size_t const idx) const noexcept
         {
-            return std::tuple{ -priority, file_index, !is_in_priority_file, !is_in_file_tail, piece };
+            return (uint64_t{ file_indexes[idx] } << 32U) |
+                (uint64_t{ (flags[idx] & PriorityFileFlag) == 0U } << 31U) |
+                (uint64_t{ (flags[idx] & TailFlag) == 0U } << 30U) | uint64_t{ pieces[idx] };
         }
 
-        [[nodiscard]] constexpr bool operator<(Candidate const& that) const noexcept
+        // high -> 0, normal -> 1, low -> 2
+        [[nodiscard]] static constexpr size_t priority_bucket(tr_priority_t const priority) noexcept
         {
-            return sort_key() < that.sort_key();
+            return priority >= TR_PRI_HIGH ? 0U : priority <= TR_PRI_LOW ? 2U : 1U;
         }
     };
 
 public:
     explicit Impl(Mediator& mediator_in);
 
-    [[nodiscard]] std::vector<tr_block_span_t> next(
-        size_t n_wanted_blocks,
-        std::function<bool(tr_piece_index_t)> const& peer_has_piece);
+    template<typename HasPieceFunc>
+    [[nodiscard]] std::vector<tr_block_span_t> next(size_t n_wanted_blocks, HasPieceFunc const& peer_has_piece);
 
 private:
+    template<bool IsSequential, typename HasPieceFunc>
+    [[nodiscard]] std::vector<tr_block_span_t> next_impl(size_t n_wanted_blocks, HasPieceFunc const& peer_has_piece);
+
     void rebuild_candidates()
     {
+        auto const wanted = mediator_.wanted_and_missing_pieces();
         auto const n_pieces = mediator_.piece_count();
         candidates_.clear();
-        candidates_.reserve(n_pieces);
+        // the bitmap's popcount is the exact candidate count, so there is
+        // no need to reserve one slot per piece of the whole torrent
+        candidates_.reserve(wanted.count());
+
+        // jump from one wanted piece to the next instead of testing
+        // every piece of the torrent
+        for (auto piece = static_cast<tr_piece_index_t>(wanted.find_first_set(0U, n_pieces)); piece < n_pieces;
+             piece = static_cast<tr_piece_index_t>(wanted.find_first_set(piece + 1U, n_pieces)))
+        {
+            auto const span = mediator_.block_span(piece);
+            candidates_.push_back(
+                piece,
+                mediator_.file_index_for_piece(piece),
+                span,
+                mediator_.priority(piece),
+                mediator_.is_piece_in_file_tail(piece),
+                mediator_.is_piece_in_priority_file(piece),
+                static_cast<uint32_t>((span.end - span.begin) - requested_.count(span.begin, span.end)));
+        }
+
+        sort_candidates();
+    }
+
+    // Sort the parallel arrays: one counting pass distributes candidates
+    // into the three priority buckets, each bucket is comparison-sorted
+    // by the remaining (file, flags, piece) key, and finally each array
+    // is gathered through the resulting permutation. Priority's domain
+    // is tiny, so this beats one big sort on the full tuple.
+    void sort_candidates()
+    {
+        auto const n = candidates_.size();
+
+        auto buckets = std::array<std::vector<uint32_t>, 3U>{};
+        for (size_t i = 0; i < n; ++i)
+        {
+            buckets[Candidates::priority_bucket(candidates_.priorities[i])].push_back(static_cast<uint32_t>(i));
+        }
+
+        auto order = std::vector<uint32_t>{};
+        order.reserve(n);
+        for (auto& bucket : buckets)
+        {
+            std::sort(
+                std::begin(bucket),
+                std::end(bucket),
+                [this](uint32_t const a, uint32_t const b) { return candidates_.sub_sort_key(a) < candidates_.sub_sort_key(b); });
+            order.insert(std::end(order), std::begin(bucket), std::end(bucket));
+        }
+
+        candidates_ = gather(candidates_, order);
+        rebuild_piece_to_index();
+    }
+
+    [[nodiscard]] static Candidates gather(Candidates const& src, std::vector<uint32_t> const& order)
+    {
+        auto tgt = Candidates{};
+        tgt.reserve(std::size(order));
+        for (auto const idx : order)
+        {
+            tgt.push_back(
+                src.pieces[idx],
+                src.file_indexes[idx],
+                src.block_spans[idx],
+                src.priorities[idx],
+                (src.flags[idx] & Candidates::TailFlag) != 0U,
+                (src.flags[idx] & Candidates::PriorityFileFlag) != 0U,
+                src.n_unrequested[idx]);
+        }
+        return tgt;
+    }
+
+    // Rebuild the piece -> candidate position lookup table.
+    // Call this whenever the candidate arrays are reordered.
+    void rebuild_piece_to_index()
+    {
+        piece_to_index_.assign(mediator_.piece_count(), NoCandidate);
+        for (size_t i = 0, n = candidates_.size(); i < n; ++i)
+        {
+            piece_to_index_[candidates_.pieces[i]] = i;
+        }
+    }
+
+    void remove_piece(tr_piece_index_t const piece)
+    {
+        if (piece >= std::size(piece_to_index_))
+        {
+            return;
+        }
+
+        auto const idx = piece_to_index_[piece];
+        if (idx == NoCandidate)
+        {
+            return;
+        }
+
+        piece_to_index_[piece] = NoCandidate;
+        candidates_.erase(idx);
+
+        // candidates after the erased one shifted down by one
+        for (auto i = idx, n = candidates_.size(); i < n; ++i)
+        {
+            piece_to_index_[candidates_.pieces[i]] = i;
+        }
+    }
 
-        for (tr_piece_index_t piece = 0U; piece < n_pieces; ++piece)
+    // a single block left the requested set; every candidate whose span
+    // contains the block gains one unrequested block
+    void on_block_unrequested(tr_block_index_t const block)
+    {
+        auto const credit = [this](tr_piece_index_t const piece)
         {
-            if (mediator_.client_wants_piece(piece) && !mediator_.client_has_piece(piece))
+            if (auto const idx = piece < std::size(piece_to_index_) ? piece_to_index_[piece] : NoCandidate;
+                idx != NoCandidate)
             {
-                candidates_.push_back(
-                    {
-                        piece,
-                        mediator_.file_index_for_piece(piece),
-                        mediator_.block_span(piece),
-                        mediator_.priority(piece),
-                        mediator_.is_piece_in_file_tail(piece),
-                        mediator_.is_piece_in_priority_file(piece),
-                    });
+                ++candidates_.n_unrequested[idx];
             }
+        };
+
+        auto const piece = mediator_.block_piece(block);
+        credit(piece);
+
+        // a block straddling a piece boundary also starts the next
+        // piece's span; credit those candidates too so this mirrors the
+        // span-overlap debit in on_sent_request()
+        for (auto next = piece + 1U; next < mediator_.piece_count() && mediator_.block_span(next).begin == block; ++next)
+        {
+            credit(next);
         }
+    }
 
-        std::sort(std::begin(candidates_), std::end(candidates_));
+    // requested_ changed in bulk (disconnect/choke); recount each
+    // candidate with one word-parallel popcount per span
+    void recount_unrequested()
+    {
+        for (size_t i = 0, n = candidates_.size(); i < n; ++i)
+        {
+            auto const span = candidates_.block_spans[i];
+            candidates_.n_unrequested[i] = static_cast<uint32_t>(
+                (span.end - span.begin) - requested_.count(span.begin, span.end));
+        }
     }
 
-    void remove_piece(tr_piece_index_t const piece)
+    void on_sent_request(tr_block_span_t const bs)
     {
-        auto const it = std::find_if(
-            std::begin(candidates_),
-            std::end(candidates_),
-            [piece](auto const& c) { return c.piece == piece; });
+        if (bs.begin >= bs.end)
+        {
+            return;
+        }
 
-        if (it != std::end(candidates_))
+        // debit each overlapped candidate by the number of its span's
+        // blocks that are newly requested, then mark the whole span with
+        // one bulk bitfield write. block_piece() maps a block to its
+        // first byte's piece, so when the span's last block straddles a
+        // piece boundary, walk 'last' forward to cover the candidates
+        // whose spans start at that block as well
+        auto last = mediator_.block_piece(bs.end - 1U);
+        while (last + 1U < mediator_.piece_count() && mediator_.block_span(last + 1U).begin == bs.end - 1U)
         {
-            candidates_.erase(it);
+            ++last;
         }
+
+        for (auto piece = mediator_.block_piece(bs.begin); piece <= last; ++piece)
+        {
+            auto const idx = piece < std::size(piece_to_index_) ? piece_to_index_[piece] : NoCandidate;
+            if (idx == NoCandidate)
+            {
+                continue;
+            }
+
+            auto const span = candidates_.block_spans[idx];
+            auto const overlap_begin = std::max(span.begin, bs.begin);
+            auto const overlap_end = std::min(span.end, bs.end);
+            if (overlap_begin >= overlap_end)
+            {
+                continue;
+            }
+
+            auto const n_newly_set = (overlap_end - overlap_begin) - requested_.count(overlap_begin, overlap_end);
+            candidates_.n_unrequested[idx] -= static_cast<uint32_t>(n_newly_set);
+        }
+
+        requested_.set_span(bs.begin, bs.end);
     }
 
-    void recalculate_priority()
+    // Refresh priorities after a priority-changed event. Only candidates
+    // belonging to the changed files are re-read, and the re-sort is
+    // skipped entirely when no sort key actually moved.
+    void recalculate_priority(tr_file_index_t const* const files, tr_file_index_t const n_files)
     {
-        for (auto& c : candidates_)
+        auto dirty = false;
+
+        for (size_t i = 0, n = candidates_.size(); i < n; ++i)
+        {
+            auto const file = candidates_.file_indexes[i];
+            if (files != nullptr && !std::any_of(files, files + n_files, [file](auto const f) { return f == file; }))
+            {
+                continue;
+            }
+
+            auto const priority = mediator_.priority(candidates_.pieces[i]);
+            dirty = dirty || priority != candidates_.priorities[i];
+            candidates_.priorities[i] = priority;
+        }
+
+        if (dirty)
+        {
+            sort_candidates();
+        }
+    }
+
+    // Bursts of files-wanted / priority events (e.g. select-all in a UI)
+    // would each trigger a full rebuild or re-sort. Observers only mark
+    // the work here; refresh_if_needed() folds a whole burst into one
+    // rebuild at the next next() call.
+    void refresh_if_needed()
+    {
+        if (rebuild_needed_)
+        {
+            rebuild_needed_ = false;
+            priority_refresh_needed_ = false;
+            priority_refresh_all_ = false;
+            pending_priority_files_.clear();
+            rebuild_candidates();
+            return;
+        }
+
+        if (priority_refresh_needed_)
+        {
+            priority_refresh_needed_ = false;
+
+            if (priority_refresh_all_)
+            {
+                recalculate_priority(nullptr, 0U);
+            }
+            else
+            {
+                recalculate_priority(
+                    std::data(pending_priority_files_),
+                    static_cast<tr_file_index_t>(std::size(pending_priority_files_)));
+            }
+
+            priority_refresh_all_ = false;
+            pending_priority_files_.clear();
+        }
+    }
+
+    // Deselecting files can only remove candidates, and removal leaves
+    // the surviving order intact, so compact the arrays in place rather
+    // than rebuilding and re-sorting the whole list. Selecting files can
+    // introduce new candidates, so that direction still defers to a full
+    // rebuild.
+    void on_files_wanted_changed(tr_file_index_t const* const files, tr_file_index_t const n_files, bool const wanted)
+    {
+        if (wanted || files == nullptr || rebuild_needed_)
+        {
+            rebuild_needed_ = true;
+            return;
+        }
+
+        auto keep = size_t{};
+        for (size_t i = 0, n = candidates_.size(); i < n; ++i)
+        {
+            // a piece straddling a deselected and a still-wanted file
+            // stays wanted, so recheck the piece rather than dropping
+            // everything tagged with a deselected file index
+            auto const file = candidates_.file_indexes[i];
+            if (std::any_of(files, files + n_files, [file](auto const f) { return f == file; }) &&
+                !mediator_.client_wants_piece(candidates_.pieces[i]))
+            {
+                continue;
+            }
+
+            if (keep != i)
+            {
+                candidates_.move_to(i, keep);
+            }
+
+            ++keep;
+        }
+
+        if (keep != candidates_.size())
         {
-            c.priority = mediator_.priority(c.piece);
-            c.file_index = mediator_.file_index_for_piece(c.piece);
+            candidates_.resize(keep);
+            rebuild_piece_to_index();
         }
-        std::sort(std::begin(candidates_), std::end(candidates_));
     }
 
-    std::vector<Candidate> candidates_;
+    void on_priority_changed(tr_file_index_t const* const files, tr_file_index_t const n_files)
+    {
+        priority_refresh_needed_ = true;
+
+        if (files == nullptr)
+        {
+            priority_refresh_all_ = true;
+        }
+        else if (!priority_refresh_all_)
+        {
+            pending_priority_files_.insert(std::end(pending_priority_files_), files, files + n_files);
+        }
+    }
+
+    static auto constexpr NoCandidate = std::numeric_limits<size_t>::max();
+
+    bool rebuild_needed_ = false;
+    bool priority_refresh_needed_ = false;
+    bool priority_refresh_all_ = false;
+    std::vector<tr_file_index_t> pending_priority_files_;
+
+    Candidates candidates_;
+    std::vector<size_t> piece_to_index_;
     tr_bitfield requested_;
+    tr_bitfield added_scratch_; // scratch for next(); all-zero between calls
     std::array<libtransmission::ObserverTag, 10U> const tags_;
     Mediator& mediator_;
 };
 
 Wishlist::Impl::Impl(Mediator& mediator_in)
     : requested_{ mediator_in.piece_count() > 0 ? mediator_in.block_span(mediator_in.piece_count() - 1).end : 0 }
+    , added_scratch_{ requested_.size() }
     , tags_{ {
-          mediator_in.observe_files_wanted_changed([this](tr_torrent*, tr_file_index_t const*, tr_file_index_t, bool)
-                                                   { rebuild_candidates(); }),
-          mediator_in.observe_peer_disconnect([this](tr_torrent*, tr_bitfield const&, tr_bitfield const& requests)
-                                              { requested_.unset_from(requests); }),
+          mediator_in.observe_files_wanted_changed(
+              [this](tr_torrent*, tr_file_index_t const* files, tr_file_index_t n_files, bool wanted)
+              { on_files_wanted_changed(files, n_files, wanted); }),
+          mediator_in.observe_peer_disconnect(
+              [this](tr_torrent*, tr_bitfield const&, tr_bitfield const& requests)
+              {
+                  requested_.unset_from(requests);
+                  recount_unrequested();
+              }),
           mediator_in.observe_got_bad_piece([](tr_torrent*, tr_piece_index_t) {}),
-          mediator_in.observe_got_block([this](tr_torrent*, tr_block_index_t b) { requested_.unset(b); }),
-          mediator_in.observe_got_choke([this](tr_torrent*, tr_bitfield const& requests) { requested_.unset_from(requests); }),
-          mediator_in.observe_got_reject([this](tr_torrent*, tr_peer*, tr_block_index_t b) { requested_.unset(b); }),
+          mediator_in.observe_got_block(
+              [this](tr_torrent*, tr_block_index_t b)
+              {
+                  if (requested_.test(b))
+                  {
+                      requested_.unset(b);
+                      on_block_unrequested(b);
+                  }
+              }),
+          mediator_in.observe_got_choke(
+              [this](tr_torrent*, tr_bitfield const& requests)
+              {
+                  requested_.unset_from(requests);
+                  recount_unrequested();
+              }),
+          mediator_in.observe_got_reject(
+              [this](tr_torrent*, tr_peer*, tr_block_index_t b)
+              {
+                  if (requested_.test(b))
+                  {
+                      requested_.unset(b);
+                      on_block_unrequested(b);
+                  }
+              }),
           mediator_in.observe_piece_completed([this](tr_torrent*, tr_piece_index_t p) { remove_piece(p); }),
-          mediator_in.observe_priority_changed([this](tr_torrent*, tr_file_index_t const*, tr_file_index_t, tr_priority_t)
-                                               { recalculate_priority(); }),
-          mediator_in.observe_sent_cancel([this](tr_torrent*, tr_peer*, tr_block_index_t b) { requested_.unset(b); }),
-          mediator_in.observe_sent_request([this](tr_torrent*, tr_peer*, tr_block_span_t bs)
-                                           { requested_.set_span(bs.begin, bs.end); }),
+          mediator_in.observe_priority_changed(
+              [this](tr_torrent*, tr_file_index_t const* files, tr_file_index_t n_files, tr_priority_t)
+              { on_priority_changed(files, n_files); }),
+          mediator_in.observe_sent_cancel(
+              [this](tr_torrent*, tr_peer*, tr_block_index_t b)
+              {
+                  if (requested_.test(b))
+                  {
+                      requested_.unset(b);
+                      on_block_unrequested(b);
+                  }
+              }),
+          mediator_in.observe_sent_request([this](tr_torrent*, tr_peer*, tr_block_span_t bs) { on_sent_request(bs); }),
       } }
     , mediator_{ mediator_in }
 {
     rebuild_candidates();
 }
 
-std::vector<tr_block_span_t> Wishlist::Impl::next(
-    size_t const n_wanted_blocks,
-    std::function<bool(tr_piece_index_t)> const& peer_has_piece)
+template<typename HasPieceFunc>
+std::vector<tr_block_span_t> Wishlist::Impl::next(size_t const n_wanted_blocks, HasPieceFunc const& peer_has_piece)
 {
+    refresh_if_needed();
+
     if (n_wanted_blocks == 0U || candidates_.empty())
     {
         return {};
     }
 
-    auto const is_sequential = mediator_.is_sequential_download();
+    // compile the sequential and non-sequential walks separately so the
+    // common non-sequential path carries none of the file-boundary state
+    return mediator_.is_sequential_download() ? next_impl<true>(n_wanted_blocks, peer_has_piece) :
+                                                next_impl<false>(n_wanted_blocks, peer_has_piece);
+}
+
+template<bool IsSequential, typename HasPieceFunc>
+std::vector<tr_block_span_t> Wishlist::Impl::next_impl(size_t const n_wanted_blocks, HasPieceFunc const& peer_has_piece)
+{
+    // hoist the client's have-set out of the loops: one bitfield probe
+    // per block instead of a virtual mediator call
+    auto const& have = mediator_.client_blocks();
     auto spans = std::vector<tr_block_span_t>{};
-    spans.reserve(n_wanted_blocks);
+    // each span covers at least one block, but contiguous runs are the
+    // norm, so reserving one slot per wanted block would overshoot the
+    // real span count by an order of magnitude on every call
+    spans.reserve(std::min(n_wanted_blocks, size_t{ 64U }));
     size_t count = 0;
 
-    // Track blocks already added (for overlapping piece spans)
-    auto added = tr_bitfield{ requested_.size() };
+    // Track blocks already added (for overlapping piece spans).
+    // The member scratch bitfield avoids allocating and zero-filling a
+    // whole-torrent bitmap on every call; the touched spans are cleared
+    // again on the way out.
+    auto& added = added_scratch_;
+
+    // candidates for adjacent pieces usually produce back-to-back spans;
+    // extend the previous entry in place instead of pushing a new one,
+    // which also keeps the tail merge pass mostly idle
+    auto const emit_span = [&spans](tr_block_index_t const begin, tr_block_index_t const end)
+    {
+        if (!std::empty(spans) && spans.back().end == begin)
+        {
+            spans.back().end = end;
+        }
+        else
+        {
+            spans.push_back({ begin, end });
+        }
+    };
 
     // Track file context for sequential mode
     auto current_priority = tr_priority_t{};
     auto current_file_index = tr_piece_index_t{};
     auto have_current_file = false;
 
-    auto const at_sequential_boundary = [&](Candidate const& c) -> bool
+    auto const at_sequential_boundary = [&](size_t const idx) -> bool
     {
-        if (!is_sequential)
+        if constexpr (!IsSequential)
         {
             return false;
         }
 
+        auto const priority = candidates_.priorities[idx];
+        auto const file_index = candidates_.file_indexes[idx];
+
         if (!have_current_file)
         {
-            current_priority = c.priority;
-            current_file_index = c.file_index;
+            current_priority = priority;
+            current_file_index = file_index;
             have_current_file = true;
             return false;
         }
 
-        if (c.priority != current_priority || c.file_index != current_file_index)
+        if (priority != current_priority || file_index != current_file_index)
         {
             if (count > 0)
             {
                 return true;
             }
-            current_priority = c.priority;
-            current_file_index = c.file_index;
+            current_priority = priority;
+            current_file_index = file_index;
         }
         return false;
     };
 
     // First pass: unrequested blocks
-    for (auto const& c : candidates_)
+    for (size_t idx = 0, n = candidates_.size(); idx < n; ++idx)
     {
-        if (count >= n_wanted_blocks || at_sequential_boundary(c))
+        if (count >= n_wanted_blocks || at_sequential_boundary(idx))
         {
             break;
         }
 
-        if (!peer_has_piece(c.piece))
+        // hide the latency of the next candidate's cold bitfield words
+        // behind the current candidate's scan
+        if (idx + 1U < n)
+        {
+            auto const next_begin = candidates_.block_spans[idx + 1U].begin;
+            requested_.prefetch(next_begin);
+            have.prefetch(next_begin);
+        }
+
+        // everything in this span is already requested; nothing to collect
+        if (candidates_.n_unrequested[idx] == 0U)
+        {
+            continue;
+        }
+
+        if (!peer_has_piece(candidates_.pieces[idx]))
         {
             continue;
         }
 
-        for (auto block = c.block_span.begin; block < c.block_span.end && count < n_wanted_blocks;)
+        auto const span = candidates_.block_spans[idx];
+        for (auto block = span.begin; block < span.end && count < n_wanted_blocks;)
         {
-            // Skip blocks that are already requested, owned, or added
-            while (block < c.block_span.end &&
-                   (requested_.test(block) || mediator_.client_has_block(block) || added.test(block)))
+            // Skip blocks that are already requested, owned, or added.
+            // find_first_unset() walks the requested bitfield a word at a
+            // time, so long already-requested runs cost one load per 64
+            // blocks instead of one branch per block.
+            while (block < span.end)
             {
+                block = requested_.find_first_unset(block, span.end);
+
+                if (block >= span.end || (!have.test(block) && !added.test(block)))
+                {
+                    break;
+                }
+
                 ++block;
             }
 
-            if (block >= c.block_span.end)
+            if (block >= span.end)
             {
                 break;
             }
 
             auto const span_begin = block++;
 
-            // Extend span
-            while (block < c.block_span.end && count + (block - span_begin) < n_wanted_blocks && !requested_.test(block) &&
-                   !mediator_.client_has_block(block) && !added.test(block))
+            // Extend the span to the first stopper: the next requested,
+            // owned, or already-added block, found word-parallel rather
+            // than with a three-way branch per block
+            if (auto const limit = std::min(size_t{ span.end }, size_t{ span_begin } + (n_wanted_blocks - count));
+                block < limit)
             {
-                ++block;
+                block = static_cast<tr_block_index_t>(std::min(
+                    { requested_.find_first_set(block, limit),
+                      have.find_first_set(block, limit),
+                      added.find_first_set(block, limit) }));
             }
 
-            spans.push_back({ span_begin, block });
+            emit_span(span_begin, block);
             added.set_span(span_begin, block);
             count += block - span_begin;
         }
@@ -219,51 +703,81 @@ std::vector<tr_block_span_t> Wishlist::Impl::next(
     {
         have_current_file = false;
 
-        for (auto const& c : candidates_)
+        for (size_t idx = 0, n = candidates_.size(); idx < n; ++idx)
         {
-            if (count >= n_wanted_blocks || at_sequential_boundary(c))
+            if (count >= n_wanted_blocks || at_sequential_boundary(idx))
             {
                 break;
             }
 
-            if (!peer_has_piece(c.piece))
+            if (!peer_has_piece(candidates_.pieces[idx]))
             {
                 continue;
             }
 
-            for (auto block = c.block_span.begin; block < c.block_span.end && count < n_wanted_blocks;)
+            auto const span = candidates_.block_spans[idx];
+            for (auto block = span.begin; block < span.end && count < n_wanted_blocks;)
             {
-                // Skip blocks that are owned or already added
-                while (block < c.block_span.end && (mediator_.client_has_block(block) || added.test(block)))
+                // Skip blocks that are owned or already added. In endgame
+                // the client already has most of a candidate's blocks, so
+                // jump over the had-runs a word at a time.
+                while (block < span.end)
                 {
+                    block = have.find_first_unset(block, span.end);
+
+                    if (block >= span.end || !added.test(block))
+                    {
+                        break;
+                    }
+
                     ++block;
                 }
 
-                if (block >= c.block_span.end)
+                if (block >= span.end)
                 {
                     break;
                 }
 
                 auto const span_begin = block++;
 
-                // Extend span
-                while (block < c.block_span.end && count + (block - span_begin) < n_wanted_blocks &&
-                       !mediator_.client_has_block(block) && !added.test(block))
+                // Extend span (like the first pass, but requested blocks
+                // are fair game for re-requests here)
+                if (auto const limit = std::min(size_t{ span.end }, size_t{ span_begin } + (n_wanted_blocks - count));
+                    block < limit)
                 {
-                    ++block;
+                    block = static_cast<tr_block_index_t>(
+                        std::min(have.find_first_set(block, limit), added.find_first_set(block, limit)));
                 }
 
-                spans.push_back({ span_begin, block });
+                emit_span(span_begin, block);
                 added.set_span(span_begin, block);
                 count += block - span_begin;
             }
         }
     }
 
-    // Merge adjacent spans
+    // restore the scratch bitfield to all-zero by clearing just the
+    // spans this call touched
+    for (auto const& span : spans)
+    {
+        added.unset_span(span.begin, span.end);
+    }
+
+    // Merge adjacent spans.
+    // Candidates are walked in sorted order, so the collected spans are
+    // usually already ascending; only sort when priority groups actually
+    // interleaved block ranges.
     if (spans.size() > 1)
     {
-        std::sort(spans.begin(), spans.end(), [](auto const& a, auto const& b) { return a.begin < b.begin; });
+        auto const by_begin = [](auto const& a, auto const& b)
+        {
+            return a.begin < b.begin;
+        };
+
+        if (!std::is_sorted(spans.begin(), spans.end(), by_begin))
+        {
+            std::sort(spans.begin(), spans.end(), by_begin);
+        }
 
         auto merged = std::vector<tr_block_span_t>{};
         merged.push_back(spans.front());
@@ -301,3 +815,15 @@ std::vector<tr_block_span_t> Wishlist::next(
 {
     return impl_->next(n_wanted_blocks, peer_has_piece);
 }
+
+std::vector<tr_block_span_t> Wishlist::next(size_t const n_wanted_blocks, tr_bitfield const& peer_have)
+{
+    // the lambda is a concrete type here, so the piece test inlines
+    // down to a single bit probe
+    return impl_->next(n_wanted_blocks, [&peer_have](tr_piece_index_t piece) { return peer_have.test(piece); });
+}
+
+std::vector<tr_block_span_t> Wishlist::next(size_t const n_wanted_blocks)
+{
+    return impl_->next(n_wanted_blocks, [](tr_piece_index_t) { return true; });
+}
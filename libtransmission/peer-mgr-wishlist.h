@@ -31,16 +31,23 @@ public:
     struct Mediator
     {
         [[nodiscard]] virtual bool client_has_block(tr_block_index_t block) const = 0;
+        [[nodiscard]] virtual tr_bitfield const& client_blocks() const = 0;
         [[nodiscard]] virtual bool client_has_piece(tr_piece_index_t piece) const = 0;
         [[nodiscard]] virtual bool client_wants_piece(tr_piece_index_t piece) const = 0;
         [[nodiscard]] virtual bool is_sequential_download() const = 0;
         [[nodiscard]] virtual tr_piece_index_t file_index_for_piece(tr_piece_index_t piece) const = 0;
         [[nodiscard]] virtual tr_block_span_t block_span(tr_piece_index_t piece) const = 0;
+        [[nodiscard]] virtual tr_piece_index_t block_piece(tr_block_index_t block) const = 0;
         [[nodiscard]] virtual tr_piece_index_t piece_count() const = 0;
         [[nodiscard]] virtual tr_priority_t priority(tr_piece_index_t piece) const = 0;
         [[nodiscard]] virtual bool is_piece_in_file_tail(tr_piece_index_t piece) const = 0;
         [[nodiscard]] virtual bool is_piece_in_priority_file(tr_piece_index_t piece) const = 0;
 
+        // the pieces the client wants but does not have yet.
+        // the default implementation probes piece-by-piece; implementors
+        // with bitfield-backed state should override with bulk span ops.
+        [[nodiscard]] virtual tr_bitfield wanted_and_missing_pieces() const;
+
         [[nodiscard]] virtual libtransmission::ObserverTag observe_files_wanted_changed(
             libtransmission::SimpleObservable<tr_torrent*, tr_file_index_t const*, tr_file_index_t, bool>::Observer) = 0;
         [[nodiscard]] virtual libtransmission::ObserverTag observe_peer_disconnect(
@@ -74,6 +81,14 @@ public:
         size_t n_wanted_blocks,
         std::function<bool(tr_piece_index_t)> const& peer_has_piece);
 
+    // same, but tests the peer's have-bitfield directly instead of
+    // going through a type-erased callback per candidate piece
+    [[nodiscard]] std::vector<tr_block_span_t> next(size_t n_wanted_blocks, tr_bitfield const& peer_have);
+
+    // same, for peers that have every piece: the per-candidate piece
+    // test compiles away entirely
+    [[nodiscard]] std::vector<tr_block_span_t> next(size_t n_wanted_blocks);
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -380,15 +380,18 @@ public:
         }
 
         [[nodiscard]] bool client_has_block(tr_block_index_t block) const override;
+        [[nodiscard]] tr_bitfield const& client_blocks() const override;
         [[nodiscard]] bool client_has_piece(tr_piece_index_t piece) const override;
         [[nodiscard]] bool client_wants_piece(tr_piece_index_t piece) const override;
         [[nodiscard]] bool is_sequential_download() const override;
         [[nodiscard]] tr_piece_index_t file_index_for_piece(tr_piece_index_t piece) const override;
         [[nodiscard]] tr_block_span_t block_span(tr_piece_index_t piece) const override;
+        [[nodiscard]] tr_piece_index_t block_piece(tr_block_index_t block) const override;
         [[nodiscard]] tr_piece_index_t piece_count() const override;
         [[nodiscard]] tr_priority_t priority(tr_piece_index_t piece) const override;
         [[nodiscard]] bool is_piece_in_file_tail(tr_piece_index_t piece) const override;
         [[nodiscard]] bool is_piece_in_priority_file(tr_piece_index_t piece) const override;
+        [[nodiscard]] tr_bitfield wanted_and_missing_pieces() const override;
 
         [[nodiscard]] libtransmission::ObserverTag observe_files_wanted_changed(
             libtransmission::SimpleObservable<tr_torrent*, tr_file_index_t const*, tr_file_index_t, bool>::Observer observer)
@@ -1040,6 +1043,11 @@ bool tr_swarm::WishlistMediator::client_has_block(tr_block_index_t block) const
     return tor_.has_block(block);
 }
 
+tr_bitfield const& tr_swarm::WishlistMediator::client_blocks() const
+{
+    return tor_.blocks();
+}
+
 bool tr_swarm::WishlistMediator::client_has_piece(tr_piece_index_t piece) const
 {
     return tor_.has_piece(piece);
@@ -1065,6 +1073,11 @@ tr_block_span_t tr_swarm::WishlistMediator::block_span(tr_piece_index_t piece) c
     return tor_.block_span_for_piece(piece);
 }
 
+tr_piece_index_t tr_swarm::WishlistMediator::block_piece(tr_block_index_t block) const
+{
+    return tor_.block_loc(block).piece;
+}
+
 tr_piece_index_t tr_swarm::WishlistMediator::piece_count() const
 {
     return tor_.piece_count();
@@ -1085,6 +1098,34 @@ bool tr_swarm::WishlistMediator::is_piece_in_priority_file(tr_piece_index_t piec
     return tor_.is_piece_in_priority_file(piece);
 }
 
+tr_bitfield tr_swarm::WishlistMediator::wanted_and_missing_pieces() const
+{
+    // build the wanted set with one span write per wanted file,
+    // then mask out the pieces we already have
+    auto pieces = tr_bitfield{ tor_.piece_count() };
+
+    for (tr_file_index_t file = 0U, n_files = tor_.file_count(); file < n_files; ++file)
+    {
+        if (!tor_.file_is_wanted(file))
+        {
+            continue;
+        }
+
+        auto const span = tor_.piece_span_for_file(file);
+        pieces.set_span(span.begin, span.end);
+    }
+
+    for (tr_piece_index_t piece = 0U, n_pieces = tor_.piece_count(); piece < n_pieces; ++piece)
+    {
+        if (pieces.test(piece) && tor_.has_piece(piece))
+        {
+            pieces.unset(piece);
+        }
+    }
+
+    return pieces;
+}
+
 libtransmission::ObserverTag tr_swarm::WishlistMediator::observe_files_wanted_changed(
     libtransmission::SimpleObservable<tr_torrent*, tr_file_index_t const*, tr_file_index_t, bool>::Observer observer)
 {
@@ -1321,7 +1362,8 @@ std::vector<tr_block_span_t> tr_peerMgrGetNextRequests(tr_torrent* torrent, tr_p
     {
         return {};
     }
-    return swarm.wishlist->next(numwant, [peer](tr_piece_index_t p) { return peer->has_piece(p); });
+    auto const& peer_have = peer->has();
+    return peer_have.has_all() ? swarm.wishlist->next(numwant) : swarm.wishlist->next(numwant, peer_have);
 }
 
 namespace
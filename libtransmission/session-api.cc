@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "libtransmission/api-compat.h"
 #include "libtransmission/net.h"
@@ -17,6 +18,7 @@
 #include "libtransmission/tr-assert.h"
 #include "libtransmission/tr-strbuf.h"
 #include "libtransmission/transmission.h"
+#include "libtransmission/utils.h"
 #include "libtransmission/variant.h"
 #include "libtransmission/values.h"
 
@@ -29,13 +31,20 @@ void tr_sessionSaveSettings(tr_session* session, char const* config_dir, tr_vari
 
     auto const filename = tr_pathbuf{ config_dir, "/settings.json"sv };
 
+    // the file is needed for the merge anyway, so read it once here
+    // and keep the raw bytes around to detect no-op saves below
+    auto old_contents = std::vector<char>{};
+    auto const had_old = tr_file_read(filename, old_contents);
+
+    auto serde = tr_variant_serde::json();
+
     // from highest to lowest precedence:
     // - actual values
     // - client settings
     // - previous session's settings stored in settings.json
     // - built-in defaults
     auto settings = tr_sessionGetDefaultSettings();
-    if (auto file_settings = tr_variant_serde::json().parse_file(filename); file_settings)
+    if (auto file_settings = had_old ? serde.parse(old_contents) : std::nullopt; file_settings)
     {
         libtransmission::api_compat::convert_incoming_data(*file_settings);
         settings.merge(*file_settings);
@@ -43,9 +52,14 @@ void tr_sessionSaveSettings(tr_session* session, char const* config_dir, tr_vari
     settings.merge(client_settings);
     settings.merge(tr_sessionGetSettings(session));
 
-    // save 'em
+    // save 'em, unless the serialized form matches what's on disk
+    // already (common on clean shutdown when a client saved earlier)
     libtransmission::api_compat::convert_outgoing_data(settings);
-    tr_variant_serde::json().to_file(settings, filename);
+    if (auto const contents = serde.to_string(settings);
+        !had_old || contents != std::string_view{ std::data(old_contents), std::size(old_contents) })
+    {
+        tr_file_save(filename, contents);
+    }
 
     tr_session_bandwidth_groups_write(session, config_dir);
 }
@@ -53,7 +67,12 @@ void tr_sessionSetDownloadDir(tr_session* session, char const* dir)
 {
     TR_ASSERT(session != nullptr);
 
-    session->setDownloadDir(dir != nullptr ? dir : "");
+    // GUIs re-push unchanged values when applying a settings dialog;
+    // skip the setter's work (and its string allocation) in that case
+    if (auto const sv = dir != nullptr ? std::string_view{ dir } : std::string_view{}; sv != session->downloadDir())
+    {
+        session->setDownloadDir(sv);
+    }
 }
 
 char const* tr_sessionGetDownloadDir(tr_session const* session)
@@ -92,7 +111,10 @@ void tr_sessionSetIncompleteDir(tr_session* session, char const* dir)
 {
     TR_ASSERT(session != nullptr);
 
-    session->setIncompleteDir(dir != nullptr ? dir : "");
+    if (auto const sv = dir != nullptr ? std::string_view{ dir } : std::string_view{}; sv != session->incompleteDir())
+    {
+        session->setIncompleteDir(sv);
+    }
 }
 
 char const* tr_sessionGetIncompleteDir(tr_session const* session)
@@ -605,7 +627,10 @@ size_t tr_blocklistSetContent(tr_session* session, char const* content_filename)
 
 void tr_blocklistSetURL(tr_session* session, char const* url)
 {
-    session->setBlocklistUrl(url != nullptr ? url : "");
+    if (auto const sv = url != nullptr ? std::string_view{ url } : std::string_view{}; sv != session->blocklistUrl())
+    {
+        session->setBlocklistUrl(sv);
+    }
 }
 
 char const* tr_blocklistGetURL(tr_session const* session)
@@ -633,17 +658,14 @@ void tr_sessionSetRPCPort(tr_session* session, uint16_t hport)
 {
     TR_ASSERT(session != nullptr);
 
-    if (session->rpc_server_)
-    {
-        session->rpc_server_->set_port(tr_port::from_host(hport));
-    }
+    session->rpc_server_->set_port(tr_port::from_host(hport));
 }
 
 uint16_t tr_sessionGetRPCPort(tr_session const* session)
 {
     TR_ASSERT(session != nullptr);
 
-    return session->rpc_server_ ? session->rpc_server_->port().host() : uint16_t{};
+    return session->rpc_server_->port().host();
 }
 
 void tr_sessionSetRPCCallback(tr_session* session, tr_rpc_func func, void* user_data)
@@ -747,7 +769,10 @@ void tr_sessionSetScript(tr_session* session, TrScript type, char const* script)
     TR_ASSERT(session != nullptr);
     TR_ASSERT(type < TR_SCRIPT_N_TYPES);
 
-    session->setScript(type, script != nullptr ? script : "");
+    if (auto const sv = script != nullptr ? std::string_view{ script } : std::string_view{}; sv != session->script(type))
+    {
+        session->setScript(type, sv);
+    }
 }
 
 char const* tr_sessionGetScript(tr_session const* session, TrScript type)
@@ -5,8 +5,10 @@
 
 #include <cstdint>
 #include <map>
-#include <string>
-#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+#include "small/vector.hpp"
 
 #include "libtransmission/file.h"
 #include "libtransmission/session.h"
@@ -16,20 +18,54 @@
 void tr_session_pause_downloads_if_low_disk_space(tr_session* session)
 {
     constexpr uint64_t min_free = uint64_t{ 1 } << 30; // 1 GiB
-    std::map<std::string, std::vector<tr_torrent*>, std::less<>> dir_to_active;
+    // key on the torrents' own dir strings instead of copying them;
+    // they outlive this function, and a hash table skips the per-node
+    // allocations a tree map would make
+    std::unordered_map<std::string_view, small::vector<tr_torrent*, 8U>> dir_to_active;
+    // most torrents share the session's default download dir and get
+    // the very same c-string back, so remember the last pointer seen
+    // and skip hashing the path again while it repeats
+    char const* last_dir = nullptr;
+    small::vector<tr_torrent*, 8U>* last_bucket = nullptr;
     for (auto* const tor : session->torrents())
     {
-        auto const* const st = tr_torrentStat(tor);
-        if (st == nullptr || st->activity != TR_STATUS_DOWNLOAD)
+        // only the activity is needed here; tr_torrentStat() would
+        // refresh the whole stat block for every torrent in the session
+        if (tor->activity() != TR_STATUS_DOWNLOAD)
             continue;
         auto const* const dir = tr_torrentGetDownloadDir(tor);
-        if (dir != nullptr && *dir != '\0')
-            dir_to_active[dir].push_back(tor);
+        if (dir == nullptr || *dir == '\0')
+            continue;
+        if (dir != last_dir)
+        {
+            last_dir = dir;
+            last_bucket = &dir_to_active[dir];
+        }
+        last_bucket->push_back(tor);
     }
+    // distinct download dirs often live on the same filesystem, so key
+    // the capacity probes by filesystem id and stat each volume once
+    std::map<uint64_t, bool> device_is_low;
     for (auto const& [path, to_pause] : dir_to_active)
     {
-        auto const cap = tr_sys_path_get_capacity(path);
-        if (!cap || cap->free < 0 || static_cast<uint64_t>(cap->free) >= min_free)
+        auto const info = tr_sys_path_get_info(path);
+        auto const device = info ? info->device : uint64_t{};
+
+        auto low = false;
+        if (auto const it = device != 0U ? device_is_low.find(device) : std::end(device_is_low);
+            it != std::end(device_is_low))
+        {
+            low = it->second;
+        }
+        else
+        {
+            auto const cap = tr_sys_path_get_capacity(path);
+            low = cap && cap->free >= 0 && static_cast<uint64_t>(cap->free) < min_free;
+            if (device != 0U)
+                device_is_low.try_emplace(device, low);
+        }
+
+        if (!low)
             continue;
         for (auto* tor : to_pause)
             tr_torrentStop(tor);
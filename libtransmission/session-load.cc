@@ -5,9 +5,9 @@
 
 #include <algorithm>
 #include <future>
-#include <iterator>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include <fmt/format.h>
@@ -24,27 +24,38 @@ using namespace std::literals;
 
 namespace
 {
-auto get_remaining_files(std::string_view folder, std::vector<std::string>& queue_order)
+struct RemainingFiles
+{
+    std::vector<std::string> torrents;
+    std::vector<std::string> magnets;
+};
+
+auto get_remaining_files(std::string_view folder, std::vector<std::string> const& queue_order)
 {
     auto files = tr_sys_dir_get_files(folder);
-    auto ret = std::vector<std::string>{};
-    ret.reserve(std::size(files));
-    std::sort(std::begin(queue_order), std::end(queue_order));
     std::sort(std::begin(files), std::end(files));
 
-    std::set_difference(
-        std::begin(files),
-        std::end(files),
-        std::begin(queue_order),
-        std::end(queue_order),
-        std::back_inserter(ret));
+    // hash the queue list once and filter with a single pass instead
+    // of sorting both lists into a set_difference; this also leaves
+    // the caller's queue_order untouched
+    auto queued = std::unordered_set<std::string_view>{};
+    queued.reserve(std::size(queue_order));
+    for (auto const& name : queue_order)
+        queued.insert(name);
 
-    // Read .torrent first if somehow a .magnet of the same hash exists
+    // Read .torrent first if somehow a .magnet of the same hash exists.
     // Example of possible cause: https://github.com/transmission/transmission/issues/5007
-    std::stable_partition(
-        std::begin(ret),
-        std::end(ret),
-        [](std::string_view name) { return tr_strv_ends_with(name, ".torrent"sv); });
+    // The suffix decides the precedence, so dispatch into two lists
+    // here instead of partitioning in a second pass.
+    auto ret = RemainingFiles{};
+    ret.torrents.reserve(std::size(files));
+    for (auto& name : files)
+    {
+        if (queued.count(name) != 0U)
+            continue;
+        auto& tgt = tr_strv_ends_with(name, ".torrent"sv) ? ret.torrents : ret.magnets;
+        tgt.push_back(std::move(name));
+    }
 
     return ret;
 }
@@ -54,17 +65,26 @@ void session_load_torrents(tr_session* session, tr_ctor* ctor, std::promise<size
     auto n_torrents = size_t{};
     auto const& folder = session->torrentDir();
 
-    auto load_func = [&folder, &n_torrents, ctor, buf = std::vector<char>{}](std::string_view name) mutable
+    // build each path by truncating one buffer back to "folder/" and
+    // appending the name, instead of constructing a fresh pathbuf
+    // (and possibly a heap block) per file
+    auto load_func = [&n_torrents,
+                      ctor,
+                      buf = std::vector<char>{},
+                      path = tr_pathbuf{ folder, '/' },
+                      prefix_len = std::size(folder) + 1U](std::string_view name) mutable
     {
         if (tr_strv_ends_with(name, ".torrent"sv))
         {
-            auto const path = tr_pathbuf{ folder, '/', name };
+            path.resize(prefix_len);
+            path.append(name);
             if (ctor->set_metainfo_from_file(path.sv()) && tr_torrentNew(ctor, nullptr) != nullptr)
                 ++n_torrents;
         }
         else if (tr_strv_ends_with(name, ".magnet"sv))
         {
-            auto const path = tr_pathbuf{ folder, '/', name };
+            path.resize(prefix_len);
+            path.append(name);
             if (tr_file_read(path, buf) &&
                 ctor->set_metainfo_from_magnet_link(std::string_view{ std::data(buf), std::size(buf) }, nullptr) &&
                 tr_torrentNew(ctor, nullptr) != nullptr)
@@ -72,11 +92,28 @@ void session_load_torrents(tr_session* session, tr_ctor* ctor, std::promise<size
         }
     };
 
-    auto queue_order = session->torrent_queue().from_file();
-    for (auto const& filename : queue_order)
-        load_func(filename);
-    for (auto const& filename : get_remaining_files(folder, queue_order))
-        load_func(filename);
+    // ask the OS to start paging in the next file while the current
+    // one is parsed, so cold-cache loads overlap read with compute
+    auto const load_all = [&folder, &load_func](std::vector<std::string> const& names)
+    {
+        for (size_t i = 0, n = std::size(names); i < n; ++i)
+        {
+            if (i + 1U < n)
+                tr_sys_path_readahead(tr_pathbuf{ folder, '/', names[i + 1U] });
+            load_func(names[i]);
+        }
+    };
+
+    auto const queue_order = session->torrent_queue().from_file();
+    auto const remaining = get_remaining_files(folder, queue_order);
+
+    // the file count bounds the torrent count, so grow the lookup
+    // tables once up front instead of reallocating while loading
+    session->torrents().reserve(std::size(queue_order) + std::size(remaining.torrents) + std::size(remaining.magnets));
+
+    load_all(queue_order);
+    load_all(remaining.torrents);
+    load_all(remaining.magnets);
 
     if (n_torrents != 0U)
     {
@@ -12,8 +12,7 @@
 class BoundSocket
 {
 public:
-    using IncomingCallback = void (*)(tr_socket_t, void*);
-    BoundSocket(struct event_base* base, tr_address const& addr, tr_port port, IncomingCallback cb, void* cb_data);
+    BoundSocket(struct event_base* base, tr_address const& addr, tr_port port, tr_session& session);
     BoundSocket(BoundSocket&&) = delete;
     BoundSocket(BoundSocket const&) = delete;
     BoundSocket operator=(BoundSocket&&) = delete;
@@ -23,12 +22,13 @@ public:
 private:
     static void onCanRead(evutil_socket_t fd, short /*what*/, void* vself)
     {
+        // the accept path is the only client, so call it directly
+        // instead of bouncing through a stored function pointer
         auto* const self = static_cast<BoundSocket*>(vself);
-        self->cb_(fd, self->cb_data_);
+        tr_session::onIncomingPeerConnection(fd, &self->session_);
     }
 
-    IncomingCallback cb_;
-    void* cb_data_;
+    tr_session& session_;
     tr_socket_t socket_ = TR_BAD_SOCKET;
     libtransmission::evhelpers::event_unique_ptr ev_;
 };
@@ -73,11 +73,21 @@ public:
             return {};
         }
 
-        return tr_address::from_string(session_.announceIP());
+        // this runs once per UDP announce but the setting rarely
+        // changes, so memoize the parse keyed on the source string
+        if (auto const& ip_str = session_.announceIP(); ip_str != announce_ip_source_)
+        {
+            announce_ip_source_ = ip_str;
+            announce_ip_cached_ = tr_address::from_string(ip_str);
+        }
+
+        return announce_ip_cached_;
     }
 
 private:
     tr_session& session_;
+    mutable std::string announce_ip_source_;
+    mutable std::optional<tr_address> announce_ip_cached_;
 };
 
 class DhtMediator : public tr_dht::Mediator
@@ -90,7 +100,7 @@ public:
 
     ~DhtMediator() noexcept override = default;
 
-    [[nodiscard]] std::vector<tr_torrent_id_t> torrents_allowing_dht() const override;
+    [[nodiscard]] small::vector<tr_torrent_id_t, 64U> torrents_allowing_dht() const override;
 
     [[nodiscard]] tr_sha1_digest_t torrent_info_hash(tr_torrent_id_t id) const override;
 
@@ -190,6 +200,10 @@ public:
 
 private:
     tr_session* const session_;
+
+    // formatted lazily on first use, then reused; the config dir is
+    // fixed for the session's lifetime
+    mutable std::string cookie_path_;
 };
 
 class LpdMediator final : public tr_lpd::Mediator
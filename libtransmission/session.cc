@@ -95,13 +95,23 @@ tr_port tr_session::randomPort() const
    designates beta (Azureus-style) */
 tr_peer_id_t tr_peerIdInit()
 {
-    auto peer_id = tr_peer_id_t{};
-    auto* it = std::data(peer_id);
-
-    // starts with -TRXXXX-
+    // starts with -TRXXXX-; bake that into a constexpr template so the
+    // runtime work begins with a plain array copy instead of copy_n
     auto constexpr Prefix = std::string_view{ PEERID_PREFIX };
-    auto const* const end = it + std::size(peer_id);
-    it = std::copy_n(std::data(Prefix), std::size(Prefix), it);
+    auto constexpr Template = []
+    {
+        auto constexpr Pfx = std::string_view{ PEERID_PREFIX };
+        auto arr = tr_peer_id_t{};
+        for (size_t i = 0; i < std::size(Pfx); ++i)
+        {
+            arr[i] = Pfx[i];
+        }
+        return arr;
+    }();
+
+    auto peer_id = Template;
+    auto* it = std::data(peer_id) + std::size(Prefix);
+    auto const* const end = std::data(peer_id) + std::size(peer_id);
 
     // remainder is randomly-generated characters
     auto constexpr Pool = std::string_view{ "0123456789abcdefghijklmnopqrstuvwxyz" };
@@ -109,25 +119,27 @@ tr_peer_id_t tr_peerIdInit()
     tr_rand_buffer(it, end - it);
     while (it + 1 < end)
     {
-        int const val = *it % std::size(Pool);
+        // multiply-shift maps the byte onto [0, Pool size) without the
+        // data-dependent `%`; the bias is the same as the modulo's
+        auto const val = static_cast<int>((static_cast<uint8_t>(*it) * std::size(Pool)) >> 8U);
         total += val;
         *it++ = Pool[val];
     }
-    int const val = total % std::size(Pool) != 0 ? std::size(Pool) - (total % std::size(Pool)) : 0;
-    *it = Pool[val];
+    // checksum char makes the vals sum to a multiple of the pool size;
+    // the double-modulo folds the `total % n == 0` case in branchlessly
+    *it = Pool[(std::size(Pool) - total % std::size(Pool)) % std::size(Pool)];
 
     return peer_id;
 }
 
 // ---
 
-std::vector<tr_torrent_id_t> tr_session::DhtMediator::torrents_allowing_dht() const
+small::vector<tr_torrent_id_t, 64U> tr_session::DhtMediator::torrents_allowing_dht() const
 {
-    auto ids = std::vector<tr_torrent_id_t>{};
-    auto const& torrents = session_.torrents();
-
-    ids.reserve(std::size(torrents));
-    for (auto const* const tor : torrents)
+    // no reserve: the inline capacity covers the common case and
+    // reserving for every torrent would defeat the point
+    auto ids = small::vector<tr_torrent_id_t, 64U>{};
+    for (auto const* const tor : session_.torrents())
     {
         if (tor->is_running() && tor->allows_dht())
         {
@@ -219,14 +231,18 @@ void tr_session::LpdMediator::setNextAnnounceTime(std::string_view info_hash_str
 
 std::optional<std::string> tr_session::WebMediator::cookieFile() const
 {
-    auto const path = tr_pathbuf{ session_->configDir(), "/cookies.txt"sv };
+    if (std::empty(cookie_path_))
+    {
+        cookie_path_ = fmt::format("{:s}/cookies.txt"sv, session_->configDir());
+    }
 
-    if (!tr_sys_path_exists(path))
+    // keep probing for existence: the user may drop the file in at runtime
+    if (!tr_sys_path_exists(cookie_path_))
     {
         return {};
     }
 
-    return std::string{ path };
+    return cookie_path_;
 }
 
 std::optional<std::string_view> tr_session::WebMediator::userAgent() const
@@ -329,14 +345,8 @@ void tr_session::onIncomingPeerConnection(tr_socket_t fd, void* vsession)
     }
 }
 
-tr_session::BoundSocket::BoundSocket(
-    struct event_base* evbase,
-    tr_address const& addr,
-    tr_port port,
-    IncomingCallback cb,
-    void* cb_data)
-    : cb_{ cb }
-    , cb_data_{ cb_data }
+tr_session::BoundSocket::BoundSocket(struct event_base* evbase, tr_address const& addr, tr_port port, tr_session& session)
+    : session_{ session }
     , socket_{ tr_netBindTCP(addr, port, false) }
     , ev_{ event_new(evbase, socket_, EV_READ | EV_PERSIST, &BoundSocket::onCanRead, this) }
 {
@@ -379,7 +389,7 @@ tr_address tr_session::bind_address(tr_address_type type) const noexcept
         // otherwise, use any_ipv6 (::).
         auto const source_addr = source_address(type);
         auto const default_addr = source_addr && source_addr->is_global_unicast() ? *source_addr : tr_address::any(TR_AF_INET6);
-        return tr_address::from_string(settings_.bind_address_ipv6).value_or(default_addr);
+        return bind_ipv6_parsed_.value_or(default_addr);
     }
 
     TR_ASSERT_MSG(false, "invalid type");
@@ -513,16 +523,19 @@ std::vector<tr_torrent*> get_next_queued_torrents(tr_torrents& torrents, tr_dire
 
     auto candidates = torrents.get_matching([dir](auto const* const tor) { return tor->is_queued(dir); });
 
-    // find the best n candidates
+    // find the best n candidates. nth_element's O(N) selection beats
+    // partial_sort's heap when only a handful are wanted out of many;
+    // the follow-up sort only has to order those n.
     num_wanted = std::min(num_wanted, std::size(candidates));
     if (num_wanted < candidates.size())
     {
-        std::partial_sort(
+        std::nth_element(
             std::begin(candidates),
             std::begin(candidates) + num_wanted,
             std::end(candidates),
             tr_torrent::CompareQueuePosition);
         candidates.resize(num_wanted);
+        std::sort(std::begin(candidates), std::end(candidates), tr_torrent::CompareQueuePosition);
     }
 
     return candidates;
@@ -694,6 +707,7 @@ void tr_session::setSettings(tr_session::Settings&& settings_in, bool force)
     }
     if (auto const& val = new_settings.bind_address_ipv6; force || val != old_settings.bind_address_ipv6)
     {
+        bind_ipv6_parsed_ = tr_address::from_string(val);
         ip_cache_->update_addr(TR_AF_INET6);
     }
 
@@ -721,14 +735,14 @@ void tr_session::setSettings(tr_session::Settings&& settings_in, bool force)
         if (auto const& val = new_settings.bind_address_ipv4; force || port_changed || val != old_settings.bind_address_ipv4)
         {
             auto const addr = bind_address(TR_AF_INET);
-            bound_ipv4_.emplace(event_base(), addr, local_peer_port_, &tr_session::onIncomingPeerConnection, this);
+            bound_ipv4_.emplace(event_base(), addr, local_peer_port_, *this);
             addr_changed = true;
         }
 
         if (auto const& val = new_settings.bind_address_ipv6; force || port_changed || val != old_settings.bind_address_ipv6)
         {
             auto const addr = bind_address(TR_AF_INET6);
-            bound_ipv6_.emplace(event_base(), addr, local_peer_port_, &tr_session::onIncomingPeerConnection, this);
+            bound_ipv6_.emplace(event_base(), addr, local_peer_port_, *this);
             addr_changed = true;
         }
     }
@@ -788,7 +802,11 @@ void tr_session::setSettings(tr_session::Settings&& settings_in, bool force)
     {
         is_proxy_disabled_for_session_ = false; // Assume healthy, disable async if check fails
         auto const proxy_url = *val;
-        std::thread(
+        if (proxy_probe_thread_.joinable())
+        {
+            proxy_probe_thread_.join();
+        }
+        proxy_probe_thread_ = std::thread(
             [this, proxy_url]()
             {
                 if (!tr_web::isProxyHealthy(proxy_url))
@@ -803,8 +821,7 @@ void tr_session::setSettings(tr_session::Settings&& settings_in, bool force)
                             is_proxy_disabled_for_session_ = true;
                         });
                 }
-            })
-            .detach();
+            });
     }
     else if (!val)
     {
@@ -945,6 +962,13 @@ void tr_session::closeImplPart1(std::promise<void>* closed_promise, std::chrono:
 {
     is_closing_ = true;
 
+    // reap the proxy health probe (if any) while it's still safe for
+    // it to post back into the session thread
+    if (proxy_probe_thread_.joinable())
+    {
+        proxy_probe_thread_.join();
+    }
+
     // close the low-hanging fruit that can be closed immediately w/o consequences
     utp_timer.reset();
     verifier_.reset();
@@ -1009,7 +1033,10 @@ void tr_session::closeImplPart1(std::promise<void>* closed_promise, std::chrono:
     // recycle the now-unused save_timer_ here to wait for UDP shutdown
     TR_ASSERT(!save_timer_);
     save_timer_ = timerMaker().create([this, closed_promise, deadline]() { closeImplPart2(closed_promise, deadline); });
-    save_timer_->start_repeating(50ms);
+    // this poll just waits for in-flight stop announces, whose latency
+    // is network-bound; 200ms is plenty responsive and keeps upkeep()
+    // from spinning over every tracker tier 20x a second
+    save_timer_->start_repeating(200ms);
 }
 
 void tr_session::closeImplPart2(std::promise<void>* closed_promise, std::chrono::time_point<std::chrono::steady_clock> deadline)
@@ -1161,6 +1188,12 @@ void tr_session::close_torrent_files(tr_torrent_id_t const tor_id) noexcept
     openFiles().close_torrent(tor_id);
 }
 
+void tr_session::close_torrent_files_no_flush(tr_torrent_id_t const tor_id) noexcept
+{
+    this->cache->drop_torrent(tor_id);
+    openFiles().close_torrent(tor_id);
+}
+
 void tr_session::close_torrent_file(tr_torrent const& tor, tr_file_index_t file_num) noexcept
 {
     this->cache->flush_file(tor, file_num);
@@ -1175,33 +1208,35 @@ auto constexpr QueueInterval = 1s;
 auto constexpr SaveInterval = 360s;
 auto constexpr DiskSpaceCheckInterval = 60s;
 
+// a plain two-piece join; no need for fmt's formatting machinery here
+std::string makeSessionSubdir(std::string_view config_dir, std::string_view name)
+{
+    auto const dir = tr_pathbuf{ config_dir, '/', name };
+    tr_sys_dir_create(dir.c_str(), TR_SYS_DIR_CREATE_PARENTS, 0777);
+    return std::string{ dir.sv() };
+}
+
 auto makeResumeDir(std::string_view config_dir)
 {
 #if defined(__APPLE__) || defined(_WIN32)
-    auto dir = fmt::format("{:s}/Resume"sv, config_dir);
+    return makeSessionSubdir(config_dir, "Resume"sv);
 #else
-    auto dir = fmt::format("{:s}/resume"sv, config_dir);
+    return makeSessionSubdir(config_dir, "resume"sv);
 #endif
-    tr_sys_dir_create(dir.c_str(), TR_SYS_DIR_CREATE_PARENTS, 0777);
-    return dir;
 }
 
 auto makeTorrentDir(std::string_view config_dir)
 {
 #if defined(__APPLE__) || defined(_WIN32)
-    auto dir = fmt::format("{:s}/Torrents"sv, config_dir);
+    return makeSessionSubdir(config_dir, "Torrents"sv);
 #else
-    auto dir = fmt::format("{:s}/torrents"sv, config_dir);
+    return makeSessionSubdir(config_dir, "torrents"sv);
 #endif
-    tr_sys_dir_create(dir.c_str(), TR_SYS_DIR_CREATE_PARENTS, 0777);
-    return dir;
 }
 
 auto makeBlocklistDir(std::string_view config_dir)
 {
-    auto dir = fmt::format("{:s}/blocklists"sv, config_dir);
-    tr_sys_dir_create(dir.c_str(), TR_SYS_DIR_CREATE_PARENTS, 0777);
-    return dir;
+    return makeSessionSubdir(config_dir, "blocklists"sv);
 }
 } // namespace
 
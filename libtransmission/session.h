@@ -23,6 +23,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <utility> // for std::pair
 #include <vector>
@@ -525,6 +526,10 @@ public:
 
     void flush_torrent_files(tr_torrent_id_t tor_id) const noexcept;
     void close_torrent_files(tr_torrent_id_t tor_id) noexcept;
+    // like close_torrent_files(), but discards dirty cache blocks
+    // instead of flushing them, e.g. when the files are about to be
+    // deleted anyway
+    void close_torrent_files_no_flush(tr_torrent_id_t tor_id) noexcept;
     void close_torrent_file(tr_torrent const& tor, tr_file_index_t file_num) noexcept;
 
     // announce ip
@@ -1126,9 +1131,19 @@ private:
 
     bool is_closing_ = false;
 
+    // Parsed form of `settings_.bind_address_ipv6`, refreshed from
+    // setSettings() so bind_address() doesn't re-parse the string on
+    // every lookup.
+    std::optional<tr_address> bind_ipv6_parsed_;
+
     // Proxy disabled for this session only (not persisted) due to health check failure
     bool is_proxy_disabled_for_session_ = false;
 
+    // Async proxy health probe. Owned (rather than detached) so that
+    // setSettings() and shutdown can reap it before it can call back
+    // into a session that's being torn down.
+    std::thread proxy_probe_thread_;
+
     /// fields that aren't trivial,
     /// but are self-contained / don't hold references to others
 
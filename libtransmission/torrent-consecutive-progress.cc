@@ -3,9 +3,37 @@
 // or any future license endorsed by Mnemosyne LLC.
 // License text can be found in the licenses/ folder.
 
+#include <algorithm> // std::max()
+
 #include "libtransmission/transmission.h"
 #include "libtransmission/torrent.h"
 
+tr_piece_index_t tr_torrent::count_consecutive_complete_pieces(
+    tr_piece_index_t const begin_piece,
+    tr_piece_index_t const end_piece) const
+{
+    // Scanning the block bitfield for the first unset block covers 64
+    // blocks per word, instead of testing each piece's blocks one
+    // piece at a time. The piece holding that block's first byte is
+    // the first incomplete piece; everything below it is complete.
+    // find_first_unset() reports blocks past the bitfield's allocated
+    // prefix as unset, so a span that lies entirely beyond the bytes
+    // written so far correctly counts as zero complete pieces.
+    auto const begin_block = block_span_for_piece(begin_piece).begin;
+    auto const end_block = block_span_for_piece(end_piece - 1U).end;
+    auto const first_missing = completion_.blocks().find_first_unset(begin_block, end_block);
+
+    if (first_missing >= end_block)
+    {
+        return end_piece - begin_piece;
+    }
+
+    // a block straddling the file's lead boundary can belong to an
+    // earlier piece, so clamp before subtracting
+    auto const piece = block_loc(static_cast<tr_block_index_t>(first_missing)).piece;
+    return std::max(piece, begin_piece) - begin_piece;
+}
+
 float tr_torrent::file_consecutive_progress(tr_file_index_t const file) const
 {
     auto const n_files = file_count();
@@ -15,43 +43,26 @@ float tr_torrent::file_consecutive_progress(tr_file_index_t const file) const
     }
 
     // Initialize cache if needed
-    if (file_consecutive_progress_.size() != n_files)
+    if (file_consecutive_pieces_.size() != n_files)
     {
-        file_consecutive_progress_.assign(n_files, -1.0F);
+        file_consecutive_pieces_.assign(n_files, 0U);
+        file_consecutive_progress_valid_ = tr_bitfield{ n_files };
     }
 
-    // Return cached value if valid
-    if (file_consecutive_progress_[file] >= 0.0F)
-    {
-        return file_consecutive_progress_[file];
-    }
-
-    // Calculate consecutive progress
     auto const [begin_piece, end_piece] = piece_span_for_file(file);
     if (begin_piece >= end_piece)
     {
-        file_consecutive_progress_[file] = 1.0F;
         return 1.0F;
     }
 
-    // Count consecutive pieces from the start
-    tr_piece_index_t consecutive_pieces = 0;
-    for (auto piece = begin_piece; piece < end_piece; ++piece)
+    if (!file_consecutive_progress_valid_.test(file))
     {
-        if (has_piece(piece))
-        {
-            ++consecutive_pieces;
-        }
-        else
-        {
-            break;
-        }
+        file_consecutive_pieces_[file] = count_consecutive_complete_pieces(begin_piece, end_piece);
+        file_consecutive_progress_valid_.set(file);
     }
 
     auto const total_pieces = end_piece - begin_piece;
-    auto const progress = static_cast<float>(consecutive_pieces) / static_cast<float>(total_pieces);
-    file_consecutive_progress_[file] = progress;
-    return progress;
+    return static_cast<float>(file_consecutive_pieces_[file]) / static_cast<float>(total_pieces);
 }
 
 void tr_torrent::update_file_consecutive_progress(tr_piece_index_t const piece)
@@ -59,15 +70,27 @@ void tr_torrent::update_file_consecutive_progress(tr_piece_index_t const piece)
     // Update cache for all files that include this piece
     for (auto [file, file_end] = fpm_.file_span_for_piece(piece); file < file_end; ++file)
     {
-        if (file < file_consecutive_progress_.size())
+        if (file >= file_consecutive_pieces_.size() || !file_consecutive_progress_valid_.test(file))
         {
-            // Invalidate cache for this file - will be recalculated on next access
-            file_consecutive_progress_[file] = -1.0F;
+            continue;
         }
+
+        // the cached prefix only grows while pieces are completed, and
+        // it can only grow when the new piece abuts it; completing a
+        // piece beyond the prefix leaves the cached count untouched
+        auto const [begin_piece, end_piece] = piece_span_for_file(file);
+        auto const count = file_consecutive_pieces_[file];
+        if (begin_piece + count >= end_piece || piece > begin_piece + count)
+        {
+            continue;
+        }
+
+        file_consecutive_pieces_[file] = count_consecutive_complete_pieces(begin_piece, end_piece);
     }
 }
 
 void tr_torrent::invalidate_file_consecutive_progress()
 {
-    file_consecutive_progress_.clear();
+    file_consecutive_pieces_.clear();
+    file_consecutive_progress_valid_ = tr_bitfield{ 0U };
 }
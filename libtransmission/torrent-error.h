@@ -9,11 +9,11 @@
 #error only libtransmission should #include this header.
 #endif
 
-#include <string>
 #include <string_view>
 
 #include "libtransmission/interned-string.h"
 #include "libtransmission/transmission.h"
+#include "libtransmission/tr-strbuf.h"
 
 /** Tracks a torrent's error state: local (e.g. file IO) or tracker (e.g. warning/error). */
 struct tr_torrent_error
@@ -47,6 +47,10 @@ struct tr_torrent_error
 
 private:
     tr_interned_string announce_url_;
-    std::string errmsg_;
+
+    // tracker warnings/errors can churn on every scrape response, so
+    // keep typical short messages in the builtin buffer instead of
+    // round-tripping through the heap allocator on each assign()
+    tr_strbuf<char, 128> errmsg_;
     tr_stat_errtype error_type_ = TR_STAT_OK;
 };
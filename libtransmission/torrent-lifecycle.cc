@@ -52,6 +52,18 @@ bool removeTorrentFile(char const* filename, void* /*user_data*/, tr_error* erro
     auto const* const session = tor->session;
     auto const torrents = session->torrents().get_all();
 
+    // size the buckets once up front; the summed file count bounds the
+    // number of paths inserted below
+    auto n_paths = size_t{};
+    for (auto const* const other : torrents)
+    {
+        if (other != tor && other->has_metainfo())
+        {
+            n_paths += other->file_count();
+        }
+    }
+    keep_paths.reserve(n_paths);
+
     for (auto const* const other : torrents)
     {
         if (other == tor || !other->has_metainfo())
@@ -146,14 +158,31 @@ void tr_torrentSetQueuePosition(tr_torrent* tor, size_t queue_position)
     tor->set_queue_position(queue_position);
 }
 
+namespace
+{
+[[nodiscard]] auto queue_move_ids(tr_torrent* const* torrents_in, size_t torrent_count)
+{
+    auto ids = std::vector<tr_torrent_id_t>{};
+    ids.reserve(torrent_count);
+    for (size_t i = 0; i < torrent_count; ++i)
+    {
+        ids.push_back(torrents_in[i]->id());
+    }
+    return ids;
+}
+} // namespace
+
 void tr_torrentsQueueMoveTop(tr_torrent* const* torrents_in, size_t torrent_count)
 {
-    auto torrents = std::vector<tr_torrent*>(torrents_in, torrents_in + torrent_count);
-    std::sort(std::rbegin(torrents), std::rend(torrents), tr_torrent::CompareQueuePosition);
-    for (auto* const tor : torrents)
+    if (torrent_count == 0U)
     {
-        tor->set_queue_position(tr_torrent_queue::MinQueuePosition);
+        return;
     }
+
+    // a single partition pass; moving the ids one at a time would cost
+    // one O(queue) rotate each
+    auto& queue = torrents_in[0]->session->torrent_queue();
+    queue.move_to_top(queue_move_ids(torrents_in, torrent_count));
 }
 
 void tr_torrentsQueueMoveUp(tr_torrent* const* torrents_in, size_t torrent_count)
@@ -184,12 +213,13 @@ void tr_torrentsQueueMoveDown(tr_torrent* const* torrents_in, size_t torrent_cou
 
 void tr_torrentsQueueMoveBottom(tr_torrent* const* torrents_in, size_t torrent_count)
 {
-    auto torrents = std::vector<tr_torrent*>(torrents_in, torrents_in + torrent_count);
-    std::sort(std::begin(torrents), std::end(torrents), tr_torrent::CompareQueuePosition);
-    for (auto* const tor : torrents)
+    if (torrent_count == 0U)
     {
-        tor->set_queue_position(tr_torrent_queue::MaxQueuePosition);
+        return;
     }
+
+    auto& queue = torrents_in[0]->session->torrent_queue();
+    queue.move_to_bottom(queue_move_ids(torrents_in, torrent_count));
 }
 
 void tr_torrent::start(bool bypass_queue, std::optional<bool> has_any_local_data)
@@ -315,12 +345,15 @@ void tr_torrentRemoveInSessionThread(
     using namespace start_stop_helpers;
 
     auto const lock = tor->unique_lock();
+    auto* const session = tor->session;
 
     bool ok = true;
     if (delete_flag && tor->has_metainfo())
     {
-        tor->session->close_torrent_files(tor->id());
-        tor->session->verify_remove(tor);
+        // the files are about to be deleted, so writing dirty cache
+        // blocks out to them first would be wasted I/O
+        session->close_torrent_files_no_flush(tor->id());
+        session->verify_remove(tor);
 
         if (delete_func == nullptr)
         {
@@ -336,9 +369,13 @@ void tr_torrentRemoveInSessionThread(
         auto keep = tr_torrent_files::KeepFunc{};
         if (!std::empty(keep_paths))
         {
-            keep = [&keep_paths](std::string_view filename)
+            // std::unordered_set has no heterogeneous lookup in C++17, so
+            // reuse one string's capacity across lookups instead of
+            // building a fresh key per candidate file
+            keep = [&keep_paths, key = std::string{}](std::string_view filename) mutable
             {
-                return keep_paths.find(std::string{ filename }) != std::end(keep_paths);
+                key.assign(filename);
+                return keep_paths.count(key) != 0U;
             };
         }
 
@@ -413,9 +450,11 @@ void tr_torrentFreeInSessionThread(tr_torrent* tor)
 
     TR_ASSERT(tr_isTorrent(tor));
     TR_ASSERT(tor->session != nullptr);
-    TR_ASSERT(tor->session->am_in_session_thread());
 
-    if (!tor->session->isClosing())
+    auto* const session = tor->session;
+    TR_ASSERT(session->am_in_session_thread());
+
+    if (!session->isClosing())
     {
         tr_logAddInfoTor(tor, _("Removing torrent"));
     }
@@ -425,9 +464,11 @@ void tr_torrentFreeInSessionThread(tr_torrent* tor)
 
     if (tor->is_deleting_)
     {
-        tr_torrent_metainfo::remove_file(tor->session->torrentDir(), tor->name(), tor->info_hash_string(), ".torrent"sv);
-        tr_torrent_metainfo::remove_file(tor->session->torrentDir(), tor->name(), tor->info_hash_string(), ".magnet"sv);
-        tr_torrent_metainfo::remove_file(tor->session->resumeDir(), tor->name(), tor->info_hash_string(), ".resume"sv);
+        auto const& name = tor->name();
+        auto const& info_hash_str = tor->info_hash_string();
+        tr_torrent_metainfo::remove_file(session->torrentDir(), name, info_hash_str, ".torrent"sv);
+        tr_torrent_metainfo::remove_file(session->torrentDir(), name, info_hash_str, ".magnet"sv);
+        tr_torrent_metainfo::remove_file(session->resumeDir(), name, info_hash_str, ".resume"sv);
     }
 
     freeTorrent(tor);
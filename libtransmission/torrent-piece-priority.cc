@@ -4,9 +4,11 @@
 // License text can be found in the licenses/ folder.
 
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <cstdint> // uint64_t
 #include <string>
 #include <string_view>
+#include <utility> // std::pair
 
 #include "libtransmission/transmission.h"
 #include "libtransmission/torrent.h"
@@ -16,174 +18,266 @@
 
 using namespace std::literals;
 
+namespace
+{
+// The extension/filename literals we match against are all plain
+// lowercase ASCII, so fold case with arithmetic instead of paying for
+// a locale-aware std::tolower per byte — and compare in place instead
+// of building a lowercased std::string per candidate.
+[[nodiscard]] constexpr char ascii_tolower(char const c) noexcept
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+[[nodiscard]] constexpr bool equals_icase(std::string_view str, std::string_view lower_case) noexcept
+{
+    auto const n = std::size(str);
+    if (n != std::size(lower_case))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (ascii_tolower(str[i]) != lower_case[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto constexpr MaxTailSize = uint64_t{ 20U * 1024U * 1024U }; // 20 MB cap for very large files
+auto constexpr MinTailSize = uint64_t{ 1024U * 1024U }; // 1 MB minimum
+auto constexpr TailPercentage = 0.02; // 2% of file size
+
+// Classification bits for the closed extension sets the priority
+// heuristics care about, so each path's extension is matched once
+// against one table instead of once per heuristic.
+//
+// Video formats often have important metadata at the end of the file
+// (e.g. MOOV atom in MP4, index in MKV/AVI) which is required for
+// seeking or even starting playback; IFO/BUP are DVD index files.
+auto constexpr ExtIsVideo = uint32_t{ 1U << 0U };
+auto constexpr ExtIsCue = uint32_t{ 1U << 1U };
+auto constexpr ExtIsCover = uint32_t{ 1U << 2U };
+auto constexpr ExtIsDiscIndex = uint32_t{ 1U << 3U };
+
+auto constexpr ExtTable = std::array<std::pair<std::string_view, uint32_t>, 11U>{ {
+    { "avi"sv, ExtIsVideo },
+    { "bup"sv, ExtIsDiscIndex },
+    { "cue"sv, ExtIsCue },
+    { "ifo"sv, ExtIsDiscIndex },
+    { "jpeg"sv, ExtIsCover },
+    { "jpg"sv, ExtIsCover },
+    { "m4v"sv, ExtIsVideo },
+    { "mkv"sv, ExtIsVideo },
+    { "mov"sv, ExtIsVideo },
+    { "mp4"sv, ExtIsVideo },
+    { "webm"sv, ExtIsVideo },
+} };
+
+[[nodiscard]] constexpr uint32_t classify_extension(std::string_view ext) noexcept
+{
+    for (auto const& [candidate, flags] : ExtTable)
+    {
+        if (equals_icase(ext, candidate))
+        {
+            return flags;
+        }
+    }
+
+    return {};
+}
+
+// Blu-ray index files (index.bdmv, movieobject.bdmv - case insensitive)
+[[nodiscard]] constexpr bool is_bluray_index_path(std::string_view path) noexcept
+{
+    if (path.size() < 10U)
+    {
+        return false;
+    }
+
+    auto const slash_pos = path.rfind('/');
+    auto const filename = path.substr(slash_pos == std::string_view::npos ? 0 : slash_pos + 1);
+    return equals_icase(filename, "index.bdmv"sv) || equals_icase(filename, "movieobject.bdmv"sv);
+}
+} // namespace
+
 void tr_torrent::update_piece_priority_state()
 {
+    auto const n = file_count();
+    file_is_video_ = tr_bitfield{ n };
+    file_is_priority_ = tr_bitfield{ n };
+    file_is_cover_ = tr_bitfield{ n };
+    file_tail_start_.assign(n, UINT64_MAX);
+
     bool has_audio = false;
     bool has_cover = false;
-    for (tr_file_index_t i = 0, n = file_count(); i < n && (!has_audio || !has_cover); ++i)
+    for (tr_file_index_t i = 0; i < n; ++i)
     {
-        auto const path = metainfo_.file_subpath(i);
-        auto const path_sv = std::string_view{ path };
-        auto const mime = tr_get_mime_type_for_filename(path);
-        if (tr_strv_starts_with(mime, "audio/"sv))
+        auto const path_sv = std::string_view{ metainfo_.file_subpath(i) };
+        auto const mime = tr_get_mime_type_for_filename(path_sv);
+
+        auto const dot_pos = path_sv.rfind('.');
+        auto const ext = dot_pos != std::string_view::npos && dot_pos + 1 < path_sv.size() ?
+            path_sv.substr(dot_pos + 1) :
+            std::string_view{};
+        auto const ext_flags = classify_extension(ext);
+
+        // The extension check is a fallback for video files that might not be
+        // in the mime-type list or might have different mime-types but still
+        // benefit from tail priority.
+        if ((ext_flags & ExtIsVideo) != 0U || tr_strv_starts_with(mime, "video/"sv))
+        {
+            file_is_video_.set(i);
+
+            // Proportional tail size: 2% of file, capped at 20 MB, minimum 1 MB.
+            // For small files the whole file counts as tail.
+            auto const byte_span = fpm_.byte_span_for_file(i);
+            auto const file_size = metainfo_.file_size(i);
+            auto const tail_size = std::min(
+                MaxTailSize,
+                std::max(MinTailSize, static_cast<uint64_t>(file_size * TailPercentage)));
+            file_tail_start_[i] = file_size <= tail_size ? byte_span.begin : byte_span.end - tail_size;
+        }
+
+        if ((ext_flags & ExtIsDiscIndex) != 0U || is_bluray_index_path(path_sv))
+        {
+            file_is_priority_.set(i);
+        }
+
+        if (tr_strv_starts_with(mime, "audio/"sv) || (ext_flags & ExtIsCue) != 0U)
         {
             has_audio = true;
         }
-        else
+        else if ((ext_flags & ExtIsCover) != 0U)
         {
-            auto const pos = path_sv.rfind('.');
-            if (pos != std::string_view::npos && pos + 1 < path_sv.size())
-            {
-                auto ext = std::string{ path_sv.substr(pos + 1) };
-                std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-                if (ext == "cue")
-                {
-                    has_audio = true;
-                }
-                else if (ext == "jpg" || ext == "jpeg")
-                {
-                    has_cover = true;
-                }
-            }
+            has_cover = true;
+            file_is_cover_.set(i);
         }
     }
     has_audio_and_cover_ = has_audio && has_cover;
 }
 
-void tr_torrent::recalculate_file_order()
+void tr_torrent::recalculate_file_order() const
 {
-    // Get list of wanted files
-    std::vector<tr_file_index_t> wanted_files;
-    wanted_files.reserve(file_count());
-    for (tr_file_index_t i = 0; i < file_count(); ++i)
+    // One pre-lowered, pre-split sort key per wanted file, so the sort
+    // comparator below is just byte compares on normalized data — the
+    // comparator used to re-split the path and case-fold byte-by-byte
+    // (O(log n) times per file), allocating along the way.
+    struct SortKey
     {
-        if (files_wanted_.file_wanted(i))
+        std::string dir;
+        std::string name;
+        size_t ext_pos; // offset of the extension (including '.') in `name`; == size() if none
+        tr_file_index_t file;
+
+        [[nodiscard]] auto base() const noexcept
         {
-            wanted_files.push_back(i);
+            return std::string_view{ name }.substr(0, ext_pos);
         }
-    }
 
-    // Sort wanted files alphabetically by path, but when one filename is a prefix
-    // of another (with same extension), shorter comes first (e.g., "file.mkv" before "file.Bonus.mkv")
-    auto const tolower_char = [](char c)
-    {
-        return std::tolower(static_cast<unsigned char>(c));
+        [[nodiscard]] auto ext() const noexcept
+        {
+            return std::string_view{ name }.substr(ext_pos);
+        }
     };
 
-    auto const compare_ci = [&tolower_char](std::string_view s1, std::string_view s2)
+    auto const to_lower_copy = [](std::string_view in)
     {
-        return std::lexicographical_compare(
-            s1.begin(),
-            s1.end(),
-            s2.begin(),
-            s2.end(),
-            [&](char c1, char c2) { return tolower_char(c1) < tolower_char(c2); });
+        auto out = std::string{};
+        out.resize(std::size(in));
+        std::transform(std::begin(in), std::end(in), std::begin(out), ascii_tolower);
+        return out;
     };
 
-    auto const equal_ci = [&tolower_char](std::string_view s1, std::string_view s2)
+    auto keys = std::vector<SortKey>{};
+    keys.reserve(file_count());
+    for (tr_file_index_t i = 0, n = file_count(); i < n; ++i)
     {
-        return s1.size() == s2.size() &&
-            std::equal(
-                   s1.begin(),
-                   s1.end(),
-                   s2.begin(),
-                   [&](char c1, char c2) { return tolower_char(c1) == tolower_char(c2); });
-    };
-
-    std::sort(
-        wanted_files.begin(),
-        wanted_files.end(),
-        [this, &compare_ci, &equal_ci](tr_file_index_t a, tr_file_index_t b)
+        if (!files_wanted_.file_wanted(i))
         {
-            auto const& path_a = files().path(a);
-            auto const& path_b = files().path(b);
+            continue;
+        }
 
-            // Split into directory and filename
-            auto const split_path = [](std::string_view path)
-            {
-                auto const pos = path.rfind('/');
-                return pos != std::string_view::npos ? std::make_pair(path.substr(0, pos), path.substr(pos + 1)) :
-                                                       std::make_pair(std::string_view{}, path);
-            };
+        auto const path = std::string_view{ files().path(i) };
 
-            auto const [dir_a, name_a] = split_path(path_a);
-            auto const [dir_b, name_b] = split_path(path_b);
+        // Split into directory and filename
+        auto const slash_pos = path.rfind('/');
+        auto const dir = slash_pos != std::string_view::npos ? path.substr(0, slash_pos) : std::string_view{};
+        auto const name = slash_pos != std::string_view::npos ? path.substr(slash_pos + 1) : path;
 
+        // Split filename into base and extension
+        auto const dot_pos = name.rfind('.');
+
+        auto& key = keys.emplace_back();
+        key.dir = to_lower_copy(dir);
+        key.name = to_lower_copy(name);
+        key.ext_pos = dot_pos != std::string_view::npos && dot_pos > 0 ? dot_pos : std::size(name);
+        key.file = i;
+    }
+
+    // Sort wanted files alphabetically by path, but when one filename is a prefix
+    // of another (with same extension), shorter comes first (e.g., "file.mkv" before "file.Bonus.mkv")
+    std::sort(
+        keys.begin(),
+        keys.end(),
+        [](SortKey const& a, SortKey const& b)
+        {
             // Compare directories first
-            if (!equal_ci(dir_a, dir_b))
+            if (a.dir != b.dir)
             {
-                return compare_ci(dir_a, dir_b);
+                return a.dir < b.dir;
             }
 
-            // Split filename into base and extension
-            auto const split_ext = [](std::string_view name)
-            {
-                auto const pos = name.rfind('.');
-                return (pos != std::string_view::npos && pos > 0) ? std::make_pair(name.substr(0, pos), name.substr(pos)) :
-                                                                    std::make_pair(name, std::string_view{});
-            };
-
-            auto const [base_a, ext_a] = split_ext(name_a);
-            auto const [base_b, ext_b] = split_ext(name_b);
-
             // If same extension and one base is prefix of another, shorter wins
-            if (equal_ci(ext_a, ext_b) && base_a.size() != base_b.size())
+            auto const base_a = a.base();
+            auto const base_b = b.base();
+            if (a.ext() == b.ext() && base_a.size() != base_b.size())
             {
                 auto const& shorter = base_a.size() < base_b.size() ? base_a : base_b;
                 auto const& longer = base_a.size() < base_b.size() ? base_b : base_a;
-                if (equal_ci(shorter, longer.substr(0, shorter.size())))
+                if (shorter == longer.substr(0, shorter.size()))
                 {
                     return base_a.size() < base_b.size();
                 }
             }
 
-            return compare_ci(name_a, name_b);
+            return a.name < b.name;
         });
 
     // Build mappings - initialize with a large value to indicate "not assigned"
-    file_index_by_piece_.assign(piece_count(), piece_count());
-
-    // Create a map from actual file index to alphabetical file index
-    std::vector<tr_piece_index_t> file_idx_map(file_count(), piece_count());
-    for (size_t file_idx = 0; file_idx < wanted_files.size(); ++file_idx)
-    {
-        auto const actual_file_index = wanted_files[file_idx];
-        file_idx_map[actual_file_index] = static_cast<tr_piece_index_t>(file_idx);
-    }
-
-    // For each piece, find which files it belongs to and assign it to the first (alphabetically)
-    for (tr_piece_index_t piece = 0; piece < piece_count(); ++piece)
+    auto const not_assigned = piece_count();
+    file_index_by_piece_.assign(piece_count(), not_assigned);
+
+    // Walk the wanted files in their new alphabetical order and let each
+    // claim the still-unassigned pieces in its span: the first claimant of
+    // a shared boundary piece is the alphabetically-first wanted file that
+    // contains it. This visits each piece once per containing file span
+    // (O(pieces + files)) instead of rescanning every file span per piece.
+    for (size_t file_idx = 0; file_idx < keys.size(); ++file_idx)
     {
-        if (!piece_is_wanted(piece))
+        auto const [piece_begin, piece_end] = piece_span_for_file(keys[file_idx].file);
+        for (auto piece = piece_begin; piece < piece_end; ++piece)
         {
-            continue;
-        }
-
-        auto const [file_begin, file_end] = fpm_.file_span_for_piece(piece);
-        tr_piece_index_t best_file_idx = piece_count();
-
-        // Find the first (alphabetically) wanted file that contains this piece
-        for (tr_file_index_t file = file_begin; file < file_end; ++file)
-        {
-            if (files_wanted_.file_wanted(file))
+            if (file_index_by_piece_[piece] == not_assigned && piece_is_wanted(piece))
             {
-                auto const alphabetical_idx = file_idx_map[file];
-                if (alphabetical_idx < best_file_idx)
-                {
-                    best_file_idx = alphabetical_idx;
-                }
+                file_index_by_piece_[piece] = static_cast<tr_piece_index_t>(file_idx);
             }
         }
-
-        if (best_file_idx < piece_count())
-        {
-            file_index_by_piece_[piece] = best_file_idx;
-        }
     }
 }
 
-tr_piece_index_t tr_torrent::file_index_for_piece(tr_piece_index_t piece) const noexcept
+tr_piece_index_t tr_torrent::file_index_for_piece(tr_piece_index_t piece) const
 {
+    if (file_order_dirty_)
+    {
+        recalculate_file_order();
+        file_order_dirty_ = false;
+    }
+
     if (piece < file_index_by_piece_.size())
     {
         return file_index_by_piece_[piece];
@@ -193,62 +287,26 @@ tr_piece_index_t tr_torrent::file_index_for_piece(tr_piece_index_t piece) const
 
 bool tr_torrent::is_video_file(tr_file_index_t file) const noexcept
 {
-    auto const mime_type = tr_get_mime_type_for_filename(metainfo_.file_subpath(file));
-    if (tr_strv_starts_with(mime_type, "video/"sv))
-    {
-        return true;
-    }
-
-    // Fallback for common video extensions that might not be in the mime-type list
-    // or might have different mime-types but still benefit from tail priority.
-    auto const path = metainfo_.file_subpath(file);
-    auto const path_sv = std::string_view{ path };
-    auto const pos = path_sv.rfind('.');
-    if (pos == std::string_view::npos || pos + 1 == path_sv.size())
-    {
-        return false;
-    }
-
-    auto ext = std::string{ path_sv.substr(pos + 1) };
-    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-
-    // These formats often have important metadata at the end of the file (e.g. MOOV atom in MP4,
-    // index in MKV/AVI) which is required for seeking or even starting playback.
-    return ext == "avi" || ext == "mp4" || ext == "mkv" || ext == "mov" || ext == "m4v" || ext == "webm";
+    return file_is_video_.test(file);
 }
 
 bool tr_torrent::is_piece_in_file_tail(tr_piece_index_t piece) const noexcept
 {
-    static constexpr uint64_t MaxTailSize = 20U * 1024U * 1024U; // 20 MB cap for very large files
-    static constexpr uint64_t MinTailSize = 1024U * 1024U; // 1 MB minimum
-    static constexpr double TailPercentage = 0.02; // 2% of file size
+    auto const piece_byte_begin = static_cast<uint64_t>(piece) * piece_size();
+    auto const piece_byte_end = piece_byte_begin + piece_size(piece);
 
     auto const [file_begin, file_end] = fpm_.file_span_for_piece(piece);
     for (auto file = file_begin; file < file_end; ++file)
     {
-        if (!files_wanted_.file_wanted(file) || !is_video_file(file))
+        if (!files_wanted_.file_wanted(file))
         {
             continue;
         }
 
-        auto const file_size = metainfo_.file_size(file);
-        // Calculate proportional tail size: 2% of file, capped at 20 MB, minimum 1 MB
-        auto const tail_size = std::min(MaxTailSize, std::max(MinTailSize, static_cast<uint64_t>(file_size * TailPercentage)));
-
-        if (file_size <= tail_size)
-        {
-            // Small file - all pieces are in "tail"
-            return true;
-        }
-
-        // Calculate byte offset of this piece within the file
-        auto const byte_span = fpm_.byte_span_for_file(file);
-        auto const piece_byte_begin = static_cast<uint64_t>(piece) * piece_size();
-        auto const piece_byte_end = piece_byte_begin + piece_size(piece);
-
-        // Check if piece overlaps with the tail portion of the file
-        auto const tail_start = byte_span.end - tail_size;
-        if (piece_byte_end > tail_start && piece_byte_begin < byte_span.end)
+        // tail starts are precomputed in update_piece_priority_state();
+        // non-video files hold UINT64_MAX so the check below always fails
+        if (file < std::size(file_tail_start_) && piece_byte_end > file_tail_start_[file] &&
+            piece_byte_begin < fpm_.byte_span_for_file(file).end)
         {
             return true;
         }
@@ -269,45 +327,15 @@ bool tr_torrent::is_piece_in_priority_file(tr_piece_index_t piece) const noexcep
             continue;
         }
 
-        auto const path = metainfo_.file_subpath(file);
-        auto const path_sv = std::string_view{ path };
-
-        // Check for DVD index files (.ifo, .bup - case insensitive)
-        if (path_sv.size() >= 4)
+        if (file_is_priority_.test(file))
         {
-            auto ext = std::string{ path_sv.substr(path_sv.size() - 4) };
-            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".ifo" || ext == ".bup")
-            {
-                return true;
-            }
-        }
-
-        // Check for Blu-ray index files (index.bdmv, movieobject.bdmv - case insensitive)
-        if (path_sv.size() >= 10)
-        {
-            auto const slash_pos = path_sv.rfind('/');
-            auto filename = std::string{ path_sv.substr(slash_pos == std::string_view::npos ? 0 : slash_pos + 1) };
-            std::transform(filename.begin(), filename.end(), filename.begin(), [](unsigned char c) { return std::tolower(c); });
-            if (filename == "index.bdmv" || filename == "movieobject.bdmv")
-            {
-                return true;
-            }
+            return true;
         }
 
         // Audio torrents: prioritize .jpg/.jpeg (album cover) so cover art downloads first
-        if (has_audio_and_cover_)
+        if (has_audio_and_cover_ && file_is_cover_.test(file))
         {
-            auto const pos = path_sv.rfind('.');
-            if (pos != std::string_view::npos && pos + 1 < path_sv.size())
-            {
-                auto ext = std::string{ path_sv.substr(pos + 1) };
-                std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-                if (ext == "jpg" || ext == "jpeg")
-                {
-                    return true;
-                }
-            }
+            return true;
         }
     }
     return false;
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <string>
+#include <unordered_set>
 #include <string_view>
 #include <vector>
 
@@ -94,6 +95,38 @@ void tr_torrent_queue::set_pos(tr_torrent_id_t const id, size_t new_pos)
     }
 }
 
+namespace
+{
+[[nodiscard]] auto make_id_set(std::vector<tr_torrent_id_t> const& ids)
+{
+    auto ret = std::unordered_set<tr_torrent_id_t>{};
+    ret.reserve(std::size(ids));
+    ret.insert(std::begin(ids), std::end(ids));
+    return ret;
+}
+} // namespace
+
+void tr_torrent_queue::move_to_top(std::vector<tr_torrent_id_t> const& ids)
+{
+    // one O(n) pass instead of one O(n) rotate per moved id
+    auto const selected = make_id_set(ids);
+    std::stable_partition(
+        std::begin(queue_),
+        std::end(queue_),
+        [&selected](tr_torrent_id_t const id) { return selected.count(id) != 0U; });
+    pos_cache_.clear();
+}
+
+void tr_torrent_queue::move_to_bottom(std::vector<tr_torrent_id_t> const& ids)
+{
+    auto const selected = make_id_set(ids);
+    std::stable_partition(
+        std::begin(queue_),
+        std::end(queue_),
+        [&selected](tr_torrent_id_t const id) { return selected.count(id) == 0U; });
+    pos_cache_.clear();
+}
+
 bool tr_torrent_queue::to_file() const
 {
     auto vec = tr_variant::Vector{};
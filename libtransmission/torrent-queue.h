@@ -43,6 +43,11 @@ public:
     [[nodiscard]] size_t get_pos(tr_torrent_id_t id);
     void set_pos(tr_torrent_id_t id, size_t new_pos);
 
+    // move `ids` to the front/back of the queue in a single pass,
+    // keeping their relative queue order
+    void move_to_top(std::vector<tr_torrent_id_t> const& ids);
+    void move_to_bottom(std::vector<tr_torrent_id_t> const& ids);
+
     bool to_file() const; // NOLINT(modernize-use-nodiscard)
     [[nodiscard]] std::vector<std::string> from_file();
 
@@ -3,6 +3,7 @@
 // or any future license endorsed by Mnemosyne LLC.
 // License text can be found in the licenses/ folder.
 
+#include <atomic>
 #include <cstddef>
 #include <ctime>
 #include <string_view>
@@ -11,6 +12,7 @@
 
 #include "libtransmission/transmission.h"
 #include "libtransmission/bitfield.h"
+#include "libtransmission/parallel-for.h"
 #include "libtransmission/tr-assert.h"
 #include "libtransmission/torrent.h"
 
@@ -24,18 +26,39 @@ void tr_torrent::ResumeHelper::load_checked_pieces(tr_bitfield const& checked, t
     TR_ASSERT(std::size(checked) == tor_.piece_count());
     tor_.checked_pieces_ = checked;
 
-    auto const n_files = tor_.file_count();
+    auto const n_files = size_t{ tor_.file_count() };
     tor_.file_mtimes_.resize(n_files);
 
-    for (size_t file = 0; file < n_files; ++file)
+    // each probe is an independent stat() and resume loading runs before
+    // the torrent starts, so find_file only reads torrent state; fan the
+    // probes out over a few tasks so the per-file syscall latency
+    // overlaps instead of serializing on big torrents
+    auto any_positive = std::atomic<bool>{ false };
+    auto const probe_mtimes = [this, &any_positive](size_t begin, size_t end)
     {
-        auto const found = tor_.find_file(file);
-        auto const mtime = found ? found->last_modified_at : 0;
+        auto found_any = false;
+        for (auto file = begin; file < end; ++file)
+        {
+            auto const found = tor_.find_file(file);
+            auto const mtime = found ? found->last_modified_at : time_t{};
+            tor_.file_mtimes_[file] = mtime;
+            found_any |= mtime > 0;
+        }
 
-        tor_.file_mtimes_[file] = mtime;
+        if (found_any)
+        {
+            any_positive.store(true, std::memory_order_relaxed);
+        }
+    };
 
+    libtransmission::parallel_for_file_ranges(n_files, probe_mtimes);
+
+    tor_.file_mtimes_any_positive_ = any_positive.load(std::memory_order_relaxed);
+
+    for (size_t file = 0; file < n_files; ++file)
+    {
         // if a file has changed, mark its pieces as unchecked
-        if (mtime == 0 || mtime != mtimes[file])
+        if (auto const mtime = tor_.file_mtimes_[file]; mtime == 0 || mtime != mtimes[file])
         {
             auto const [piece_begin, piece_end] = tor_.piece_span_for_file(file);
             tor_.checked_pieces_.unset_span(piece_begin, piece_end);
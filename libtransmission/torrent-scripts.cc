@@ -5,7 +5,6 @@
 
 #include <array>
 #include <map>
-#include <sstream>
 #include <string>
 #include <string_view>
 
@@ -33,36 +32,49 @@ namespace script_helpers
 {
 [[nodiscard]] std::string build_labels_string(tr_torrent::labels_t const& labels)
 {
-    auto buf = std::stringstream{};
+    auto total = std::size(labels); // commas + NUL slack
+    for (auto const& label : labels)
+    {
+        total += std::size(label.sv());
+    }
+
+    auto buf = std::string{};
+    buf.reserve(total);
 
     for (auto it = std::begin(labels), end = std::end(labels); it != end;)
     {
-        buf << it->sv();
+        buf += it->sv();
 
         if (++it != end)
         {
-            buf << ',';
+            buf += ',';
         }
     }
 
-    return buf.str();
+    return buf;
 }
 
 [[nodiscard]] std::string buildTrackersString(tr_torrent const* tor)
 {
-    auto buf = std::stringstream{};
+    auto const n = tr_torrentTrackerCount(tor);
 
-    for (size_t i = 0, n = tr_torrentTrackerCount(tor); i < n; ++i)
-    {
-        buf << tr_torrentTracker(tor, i).host_and_port;
+    // tr_torrentTracker() walks the announcer tiers per call, so don't
+    // do an exact-size counting pass; a host:port estimate is enough to
+    // avoid growth reallocations in practice
+    auto buf = std::string{};
+    buf.reserve(n * 32U);
 
-        if (i < n)
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i != 0U)
         {
-            buf << ',';
+            buf += ',';
         }
+
+        buf += tr_torrentTracker(tor, i).host_and_port;
     }
 
-    return buf.str();
+    return buf;
 }
 
 void torrentCallScript(tr_torrent const* tor, std::string const& script)
@@ -83,7 +95,7 @@ void torrentCallScript(tr_torrent const* tor, std::string const& script)
     auto const labels_str = build_labels_string(tor->labels());
     auto const trackers_str = buildTrackersString(tor);
     auto const bytes_downloaded_str = std::to_string(tor->bytes_downloaded_.ever());
-    auto const localtime_str = fmt::format("{:%a %b %d %T %Y%n}", *std::localtime(&now));
+    auto const localtime_str = fmt::format("{:%a %b %d %T %Y%n}", fmt::localtime(now));
     auto const priority_str = std::to_string(tor->get_priority());
 
     auto const env = std::map<std::string_view, std::string_view>{
@@ -20,17 +20,15 @@ struct tr_smoothed_speed
 
     constexpr auto update(uint64_t time_msec, Speed speed)
     {
-        if (timestamp_msec_ + MaxAgeMSec <= time_msec)
-        {
-            timestamp_msec_ = time_msec;
-            speed_ = speed;
-        }
-        else if (timestamp_msec_ + MinUpdateMSec <= time_msec)
-        {
-            timestamp_msec_ = time_msec;
-            speed_ = (speed_ * 4U + speed) / 5U;
-        }
-
+        // compute both candidates and select: mixed-activity torrent
+        // lists make these predicates unpredictable, so conditional
+        // moves beat two data-dependent branches in the stats() poll
+        bool const full_reset = timestamp_msec_ + MaxAgeMSec <= time_msec;
+        bool const do_update = timestamp_msec_ + MinUpdateMSec <= time_msec;
+        auto const ema = (speed_ * 4U + speed) / 5U;
+
+        speed_ = full_reset ? speed : (do_update ? ema : speed_);
+        timestamp_msec_ = do_update ? time_msec : timestamp_msec_;
         return speed_;
     }
 
@@ -4,6 +4,7 @@
 // License text can be found in the licenses/ folder.
 
 #include <algorithm>
+#include <cstring> // std::memcpy
 #include <optional>
 #include <vector>
 
@@ -67,6 +68,11 @@ bool tr_torrentGetSeedRatio(tr_torrent const* const tor, double* ratio)
 }
 
 tr_stat tr_torrent::stats() const
+{
+    return stats(tr_time_msec(), tr_time());
+}
+
+tr_stat tr_torrent::stats(uint64_t const now_msec, time_t const now_sec) const
 {
     static auto constexpr IsStalled = [](tr_torrent const* const tor, std::optional<time_t> idle_secs)
     {
@@ -76,9 +82,6 @@ tr_stat tr_torrent::stats() const
 
     auto const lock = unique_lock();
 
-    auto const now_msec = tr_time_msec();
-    auto const now_sec = tr_time();
-
     auto const swarm_stats = this->swarm != nullptr ? tr_swarmGetStats(this->swarm) : tr_swarm_stats{};
     auto const activity = this->activity();
     auto const idle_seconds = this->idle_seconds(now_sec);
@@ -98,15 +101,17 @@ tr_stat tr_torrent::stats() const
     stats.peersGettingFromUs = swarm_stats.active_peer_count[TR_UP];
     stats.webseedsSendingToUs = swarm_stats.active_webseed_count;
 
-    for (int i = 0; i < TR_PEER_FROM_N_TYPES; i++)
-    {
-        stats.peersFrom[i] = swarm_stats.peer_from_count[i];
-        stats.knownPeersFrom[i] = swarm_stats.known_peer_from_count[i];
-    }
+    static_assert(sizeof(stats.peersFrom) == sizeof(swarm_stats.peer_from_count));
+    static_assert(sizeof(stats.knownPeersFrom) == sizeof(swarm_stats.known_peer_from_count));
+    std::memcpy(stats.peersFrom, std::data(swarm_stats.peer_from_count), sizeof(stats.peersFrom));
+    std::memcpy(stats.knownPeersFrom, std::data(swarm_stats.known_peer_from_count), sizeof(stats.knownPeersFrom));
 
-    auto const piece_upload_speed = bandwidth().get_piece_speed(now_msec, TR_UP);
+    // stopped / queued / verifying torrents — often most of a session —
+    // transfer nothing, so skip the bandwidth queries and report zero
+    auto const is_transferring = activity == TR_STATUS_DOWNLOAD || activity == TR_STATUS_SEED;
+    auto const piece_upload_speed = is_transferring ? bandwidth().get_piece_speed(now_msec, TR_UP) : Speed{};
     stats.pieceUploadSpeed_KBps = piece_upload_speed.count(Speed::Units::KByps);
-    auto const piece_download_speed = bandwidth().get_piece_speed(now_msec, TR_DOWN);
+    auto const piece_download_speed = is_transferring ? bandwidth().get_piece_speed(now_msec, TR_DOWN) : Speed{};
     stats.pieceDownloadSpeed_KBps = piece_download_speed.count(Speed::Units::KByps);
 
     stats.percentComplete = this->completion_.percent_complete();
@@ -132,7 +137,9 @@ tr_stat tr_torrent::stats() const
     stats.uploadedEver = this->bytes_uploaded_.ever();
     stats.haveValid = this->completion_.has_valid();
     stats.haveUnchecked = this->has_total() - stats.haveValid;
-    stats.desiredAvailable = tr_peerMgrGetDesiredAvailable(this);
+    // desired availability only matters (and is only nonzero) while
+    // downloading; the peer-mgr walk is a bitfield scan worth skipping
+    stats.desiredAvailable = activity == TR_STATUS_DOWNLOAD ? tr_peerMgrGetDesiredAvailable(this) : uint64_t{};
 
     stats.ratio = tr_getRatio(stats.uploadedEver, this->size_when_done());
 
@@ -142,31 +149,37 @@ tr_stat tr_torrent::stats() const
 
     stats.eta = TR_ETA_NOT_AVAIL;
     stats.etaIdle = TR_ETA_NOT_AVAIL;
-    if (activity == TR_STATUS_DOWNLOAD)
-    {
-        if (auto const eta_speed_byps = eta_speed_.update(now_msec, piece_download_speed).base_quantity(); eta_speed_byps == 0U)
-        {
-            stats.eta = TR_ETA_UNKNOWN;
-        }
-        else if (stats.leftUntilDone <= stats.desiredAvailable || webseed_count() >= 1U)
-        {
-            stats.eta = stats.leftUntilDone / eta_speed_byps;
-        }
-    }
-    else if (activity == TR_STATUS_SEED)
+    if (activity == TR_STATUS_DOWNLOAD || activity == TR_STATUS_SEED)
     {
-        auto const eta_speed_byps = eta_speed_.update(now_msec, piece_upload_speed).base_quantity();
+        // one smoothed-speed update against the activity-selected speed
+        auto const eta_src = activity == TR_STATUS_SEED ? piece_upload_speed : piece_download_speed;
+        auto const eta_speed_byps = eta_speed_.update(now_msec, eta_src).base_quantity();
 
-        if (seed_ratio_applies)
+        if (activity == TR_STATUS_DOWNLOAD)
         {
-            stats.eta = eta_speed_byps == 0U ? static_cast<time_t>(TR_ETA_UNKNOWN) : seed_ratio_bytes_left / eta_speed_byps;
+            if (eta_speed_byps == 0U)
+            {
+                stats.eta = TR_ETA_UNKNOWN;
+            }
+            else if (stats.leftUntilDone <= stats.desiredAvailable || webseed_count() >= 1U)
+            {
+                stats.eta = stats.leftUntilDone / eta_speed_byps;
+            }
         }
-
-        if (eta_speed_byps < 1U)
+        else
         {
-            if (auto const secs_left = idle_seconds_left(now_sec); secs_left)
+            if (seed_ratio_applies)
+            {
+                stats.eta = eta_speed_byps == 0U ? static_cast<time_t>(TR_ETA_UNKNOWN) :
+                                                   seed_ratio_bytes_left / eta_speed_byps;
+            }
+
+            if (eta_speed_byps < 1U)
             {
-                stats.etaIdle = *secs_left;
+                if (auto const secs_left = idle_seconds_left(now_sec); secs_left)
+                {
+                    stats.etaIdle = *secs_left;
+                }
             }
         }
     }
@@ -174,18 +187,12 @@ tr_stat tr_torrent::stats() const
     stats.finished = this->finished_seeding_by_idle_ ||
         (seed_ratio_applies && seed_ratio_bytes_left == 0 && stats.haveValid != 0);
 
-    if (!seed_ratio_applies || stats.finished)
-    {
-        stats.seedRatioPercentDone = 1.0F;
-    }
-    else if (seed_ratio_bytes_goal == 0)
-    {
-        stats.seedRatioPercentDone = 0.0F;
-    }
-    else
-    {
-        stats.seedRatioPercentDone = float(seed_ratio_bytes_goal - seed_ratio_bytes_left) / seed_ratio_bytes_goal;
-    }
+    // same three outcomes as the old if / else-if cascade, but with the
+    // cheap computations folded into selects instead of nested branches
+    auto const seed_ratio_frac = seed_ratio_bytes_goal != 0U ?
+        float(seed_ratio_bytes_goal - seed_ratio_bytes_left) / seed_ratio_bytes_goal :
+        0.0F;
+    stats.seedRatioPercentDone = !seed_ratio_applies || stats.finished ? 1.0F : seed_ratio_frac;
 
     TR_ASSERT(stats.sizeWhenDone <= this->total_size());
     TR_ASSERT(stats.leftUntilDone <= stats.sizeWhenDone);
@@ -209,10 +216,15 @@ std::vector<tr_stat const*> tr_torrentStat(tr_torrent* const* torrents, size_t n
 
         auto const lock = torrents[0]->unique_lock();
 
+        // one clock read for the whole batch; each stats() call still
+        // takes the (recursive) session lock cheaply under ours
+        auto const now_msec = tr_time_msec();
+        auto const now_sec = tr_time();
+
         for (size_t idx = 0U; idx != n_torrents; ++idx)
         {
             tr_torrent* const tor = torrents[idx];
-            tor->stats_ = tor->stats();
+            tor->stats_ = tor->stats(now_msec, now_sec);
             ret.emplace_back(&tor->stats_);
         }
     }
@@ -235,6 +247,14 @@ tr_file_view tr_torrentFile(tr_torrent const* tor, tr_file_index_t file)
         return { subpath.c_str(), length, length, 1.0, begin, end, priority, wanted };
     }
 
+    // a word-at-a-time popcount over the file's block span; when the
+    // file is fully downloaded this skips the per-block byte accounting
+    // done by count_has_bytes_in_span() below
+    if (tor->has_blocks(tor->block_span_for_file(file)))
+    {
+        return { subpath.c_str(), length, length, 1.0, begin, end, priority, wanted };
+    }
+
     auto const have = tor->completion_.count_has_bytes_in_span(tor->byte_span_for_file(file));
     return { subpath.c_str(), have, length, have >= length ? 1.0 : have / double(length), begin, end, priority, wanted };
 }
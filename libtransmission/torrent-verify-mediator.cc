@@ -3,7 +3,8 @@
 // or any future license endorsed by Mnemosyne LLC.
 // License text can be found in the licenses/ folder.
 
-#include <algorithm>
+#include <algorithm> // std::clamp()
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -12,6 +13,7 @@
 #include "libtransmission/transmission.h"
 #include "libtransmission/error.h"
 #include "libtransmission/log.h"
+#include "libtransmission/parallel-for.h"
 #include "libtransmission/platform.h"
 #include "libtransmission/torrent.h"
 #include "libtransmission/torrent-files.h"
@@ -44,6 +46,30 @@ std::optional<std::string> tr_torrent::VerifyMediator::find_file(tr_file_index_t
 }
 
 void tr_torrent::update_file_path(tr_file_index_t file, std::optional<bool> has_file) const
+{
+    update_file_path_impl(file, has_file, session->isIncompleteFileNamingEnabled());
+}
+
+void tr_torrent::update_all_file_paths() const
+{
+    auto const incomplete_naming = session->isIncompleteFileNamingEnabled();
+    auto const n_files = size_t{ file_count() };
+
+    auto const update_range = [this, incomplete_naming](size_t begin, size_t end)
+    {
+        for (auto file = begin; file < end; ++file)
+        {
+            update_file_path_impl(static_cast<tr_file_index_t>(file), {}, incomplete_naming);
+        }
+    };
+
+    // each file is stat-ed and possibly renamed independently, so fan
+    // big torrents out over a few tasks to overlap the filesystem
+    // metadata latency; we block here, so torrent state stays stable
+    libtransmission::parallel_for_file_ranges(n_files, update_range);
+}
+
+void tr_torrent::update_file_path_impl(tr_file_index_t file, std::optional<bool> has_file, bool const incomplete_naming) const
 {
     auto const found = find_file(file);
     if (!found)
@@ -52,7 +78,7 @@ void tr_torrent::update_file_path(tr_file_index_t file, std::optional<bool> has_
     }
 
     auto const has = has_file ? *has_file : this->has_file(file);
-    auto const needs_suffix = session->isIncompleteFileNamingEnabled() && !has;
+    auto const needs_suffix = incomplete_naming && !has;
     auto const oldpath = found->filename();
     auto const newpath = needs_suffix ?
         tr_pathbuf{ found->base(), '/', file_subpath(file), tr_torrent_files::PartialFileSuffix } :
@@ -86,6 +112,8 @@ void tr_torrent::VerifyMediator::on_verify_started()
 {
     tr_logAddDebugTor(tor_, "Verifying torrent");
     time_started_ = tr_time();
+    auto const n_pieces = tor_->metainfo_.piece_count();
+    inv_piece_count_ = n_pieces != 0U ? 1.0F / static_cast<float>(n_pieces) : 0.0F;
     tor_->set_verify_state(VerifyState::Active);
 }
 
@@ -99,13 +127,15 @@ void tr_torrent::VerifyMediator::on_piece_checked(tr_piece_index_t const piece,
 
     tor_->checked_pieces_.set(piece, true);
     tor_->mark_changed();
-    tor_->verify_progress_ = std::clamp(static_cast<float>(piece + 1U) / tor_->metainfo_.piece_count(), 0.0F, 1.0F);
+    tor_->verify_progress_ = std::clamp(static_cast<float>(piece + 1U) * inv_piece_count_, 0.0F, 1.0F);
 }
 
 // (usually called from tr_verify_worker's thread)
 void tr_torrent::VerifyMediator::on_verify_done(bool const aborted)
 {
-    if (time_started_.has_value())
+    // the level check also guards the clock read and the divide; the
+    // format call itself is already lazy inside the macro
+    if (time_started_.has_value() && tr_logLevelIsActive(TR_LOG_DEBUG))
     {
         auto const total_size = tor_->total_size();
         auto const duration_secs = tr_time() - *time_started_;
@@ -133,10 +163,7 @@ void tr_torrent::VerifyMediator::on_verify_done(bool const aborted)
                     return;
                 }
 
-                for (tr_file_index_t file = 0, n_files = tor->file_count(); file < n_files; ++file)
-                {
-                    tor->update_file_path(file, {});
-                }
+                tor->update_all_file_paths();
 
                 tor->recheck_completeness();
 
@@ -5,10 +5,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
 #include <cerrno> // EINVAL
 #include <chrono>
 #include <cstddef> // size_t
+#include <cstdint> // uintptr_t
 #include <ctime>
 #include <map>
 #include <sstream>
@@ -35,6 +37,7 @@
 #include "libtransmission/inout.h" // tr_ioTestPiece()
 #include "libtransmission/log.h"
 #include "libtransmission/magnet-metainfo.h"
+#include "libtransmission/parallel-for.h"
 #include "libtransmission/peer-common.h"
 #include "libtransmission/peer-mgr.h"
 #include "libtransmission/resume.h"
@@ -262,32 +265,35 @@ bool tr_torrent::is_new_torrent_a_seed()
         return false;
     }
 
-    for (tr_file_index_t i = 0, n = file_count(); i < n; ++i)
+    auto const n_files = size_t{ file_count() };
+
+    // each probe is an independent find_file() stat; fan big torrents
+    // out over a few tasks so the per-file syscall latency overlaps,
+    // and let any rejection stop the other tasks early
+    auto reject = std::atomic<bool>{ false };
+    auto const check_range = [this, &reject](size_t begin, size_t end)
     {
-        // it's not a new seed if a file is missing
-        auto const found = find_file(i);
-        if (!found)
+        for (auto i = begin; i < end && !reject.load(std::memory_order_relaxed); ++i)
         {
-            return false;
-        }
+            auto const file = static_cast<tr_file_index_t>(i);
 
-        // it's not a new seed if a file is partial
-        if (tr_strv_ends_with(found->filename(), tr_torrent_files::PartialFileSuffix))
-        {
-            return false;
+            // it's not a new seed if a file is missing, is partial,
+            // has the wrong size, or was modified after it was added
+            auto const found = find_file(file);
+            if (!found || tr_strv_ends_with(found->filename(), tr_torrent_files::PartialFileSuffix) ||
+                found->size != file_size(file) || found->last_modified_at >= date_added_)
+            {
+                reject.store(true, std::memory_order_relaxed);
+                return;
+            }
         }
+    };
 
-        // it's not a new seed if a file size is wrong
-        if (found->size != file_size(i))
-        {
-            return false;
-        }
+    libtransmission::parallel_for_file_ranges(n_files, check_range);
 
-        // it's not a new seed if it was modified after it was added
-        if (found->last_modified_at >= date_added_)
-        {
-            return false;
-        }
+    if (reject.load(std::memory_order_relaxed))
+    {
+        return false;
     }
 
     // check the first piece
@@ -303,6 +309,7 @@ void tr_torrent::on_metainfo_updated()
     file_priorities_ = tr_file_priorities{ &fpm_ };
     files_wanted_ = tr_files_wanted{ &fpm_ };
     checked_pieces_ = tr_bitfield{ size_t(piece_count()) };
+    is_folder_ = file_count() > 1 || (file_count() == 1 && tr_strv_contains(file_subpath(0), '/'));
     update_piece_priority_state();
 }
 
@@ -400,8 +407,8 @@ void tr_torrent::init(tr_ctor const& ctor)
     ctor.init_torrent_priorities(*this);
     ctor.init_torrent_wanted(*this);
 
-    // Always recalculate file order for alphabetical download ordering
-    recalculate_file_order();
+    // File order for alphabetical download ordering is rebuilt on demand
+    invalidate_file_order();
 
     refresh_current_dir();
 
@@ -433,10 +440,9 @@ void tr_torrent::init(tr_ctor const& ctor)
     // didn't record any progress OR it recorded zero verified blocks
     if (((loaded & tr_resume::Progress) == 0) || this->has_none())
     {
-        has_any_local_data = std::any_of(
-            std::begin(file_mtimes_),
-            std::end(file_mtimes_),
-            [](auto mtime) { return mtime > 0; });
+        // the resume-time mtime probe already tracked this, so no need
+        // to rescan the whole vector here
+        has_any_local_data = file_mtimes_any_positive_;
     }
 
     auto const file_path = store_file();
@@ -505,7 +511,7 @@ void tr_torrent::set_metainfo(tr_torrent_metainfo tm)
     TR_ASSERT(!has_metainfo());
     metainfo_ = std::move(tm);
     on_metainfo_updated();
-    recalculate_file_order();
+    invalidate_file_order();
 
     got_metainfo_.emit(this);
     session->onMetadataCompleted(this);
@@ -631,7 +637,7 @@ tr_torrent_view tr_torrentView(tr_torrent const* tor)
     ret.piece_size = tor->piece_size();
     ret.n_pieces = tor->piece_count();
     ret.is_private = tor->is_private();
-    ret.is_folder = tor->file_count() > 1 || (tor->file_count() == 1 && tr_strv_contains(tor->file_subpath(0), '/'));
+    ret.is_folder = tor->is_folder();
 
     return ret;
 }
@@ -784,6 +790,7 @@ void tr_torrent::create_empty_files() const
     }
 
     auto const file_count = this->file_count();
+    auto last_created_dir = tr_pathbuf{};
     for (tr_file_index_t file_index = 0U; file_index < file_count; ++file_index)
     {
         if (file_size(file_index) != 0U || !file_is_wanted(file_index) || find_file(file_index))
@@ -797,10 +804,16 @@ void tr_torrent::create_empty_files() const
         auto const& subpath = file_subpath(file_index);
         filename.assign(base, '/', subpath);
 
-        // create subfolders, if any
+        // create subfolders, if any. metainfo lists files grouped by
+        // directory, so remembering the last directory created skips
+        // the repeated path-walking mkdir calls for shared parents
         auto dir = tr_pathbuf{ filename.sv() };
         dir.popdir();
-        tr_sys_dir_create(dir, TR_SYS_DIR_CREATE_PARENTS, 0777);
+        if (dir.sv() != last_created_dir.sv())
+        {
+            tr_sys_dir_create(dir, TR_SYS_DIR_CREATE_PARENTS, 0777);
+            last_created_dir.assign(dir.sv());
+        }
 
         // create the file
         if (auto const fd = tr_sys_file_open(filename, TR_SYS_FILE_WRITE | TR_SYS_FILE_CREATE | TR_SYS_FILE_SEQUENTIAL, 0666);
@@ -895,15 +908,19 @@ void tr_torrent::set_labels(labels_t const& new_labels)
 {
     auto const lock = unique_lock();
     labels_.clear();
+    labels_.reserve(std::size(new_labels));
 
-    for (auto label : new_labels)
+    // labels are interned, so dedupe on the quark id in O(1) per label
+    // instead of rescanning the accepted list for every insert
+    auto seen = std::unordered_set<tr_quark>{};
+    seen.reserve(std::size(new_labels));
+    for (auto const& label : new_labels)
     {
-        if (std::find(std::begin(labels_), std::end(labels_), label) == std::end(labels_))
+        if (seen.insert(label.quark()).second)
         {
             labels_.push_back(label);
         }
     }
-    labels_.shrink_to_fit();
     set_dirty();
     mark_edited();
 }
@@ -1047,15 +1064,34 @@ std::string_view tr_torrent::primary_mime_type() const
 {
     // count up how many bytes there are for each mime-type in the torrent
     // NB: get_mime_type_for_filename() always returns the same ptr for a
-    // mime_type, so its raw pointer can be used as a key.
-    auto size_per_mime_type = small::unordered_map<std::string_view, size_t, 256U>{};
+    // mime_type, so its raw pointer can be used as a key — which also
+    // means hashing the pointer is as good as hashing the characters.
+    struct MimeTypePtrHash
+    {
+        [[nodiscard]] size_t operator()(std::string_view mime_type) const noexcept
+        {
+            return reinterpret_cast<uintptr_t>(std::data(mime_type)) >> 3U;
+        }
+    };
+
+    auto size_per_mime_type = small::unordered_map<std::string_view, size_t, 256U, MimeTypePtrHash>{};
+
+    // track the winner while accumulating so there's no second pass
+    // over the map afterwards
+    auto best_mime_type = std::string_view{};
+    auto best_size = size_t{};
     for (tr_file_index_t i = 0, n = this->file_count(); i < n; ++i)
     {
         auto const mime_type = tr_get_mime_type_for_filename(this->file_subpath(i));
-        size_per_mime_type[mime_type] += this->file_size(i);
+        auto const total = size_per_mime_type[mime_type] += this->file_size(i);
+        if (std::empty(best_mime_type) || total > best_size)
+        {
+            best_mime_type = mime_type;
+            best_size = total;
+        }
     }
 
-    if (std::empty(size_per_mime_type))
+    if (std::empty(best_mime_type))
     {
         // https://developer.mozilla.org/en-US/docs/Web/HTTP/Basics_of_HTTP/MIME_types/Common_types
         // application/octet-stream is the default value for all other cases.
@@ -1064,11 +1100,7 @@ std::string_view tr_torrent::primary_mime_type() const
         return Fallback;
     }
 
-    auto const it = std::max_element(
-        std::begin(size_per_mime_type),
-        std::end(size_per_mime_type),
-        [](auto const& a, auto const& b) { return a.second < b.second; });
-    return it->first;
+    return best_mime_type;
 }
 
 // ---
@@ -1098,11 +1130,22 @@ void tr_torrent::on_piece_completed(tr_piece_index_t const piece)
     // Update consecutive progress cache for affected files
     update_file_consecutive_progress(piece);
 
-    // in sequential mode, flush files as soon a piece
-    // is completed to let other programs read the written data
-    if (is_sequential_download())
+    // in sequential mode, flush files as soon a piece is completed to
+    // let other programs read the written data. pieces often complete
+    // in bursts, so queue the flush behind the pending event-loop work
+    // and issue it once per burst instead of once per piece
+    if (is_sequential_download() && !sequential_flush_pending_)
     {
-        session->flush_torrent_files(id());
+        sequential_flush_pending_ = true;
+        session->queue_session_thread(
+            [session = this->session, id = this->id()]()
+            {
+                if (auto* const tor = session->torrents().get(id); tor != nullptr)
+                {
+                    tor->sequential_flush_pending_ = false;
+                    session->flush_torrent_files(id);
+                }
+            });
     }
 
     // if this piece completes any file, invoke the fileCompleted func for it
@@ -1143,7 +1186,14 @@ void tr_torrent::on_block_received(tr_block_index_t const block)
 
     auto const block_loc = this->block_loc(block);
     auto const first_piece = block_loc.piece;
-    auto const last_piece = byte_loc(block_loc.byte + block_size(block) - 1).piece;
+
+    // blocks are BlockSize and pieces are at least that big, so a block
+    // almost never straddles a piece boundary; skip the second
+    // byte_loc() division when the block ends inside first_piece
+    auto const block_end_offset = uint64_t{ block_loc.piece_offset } + block_size(block);
+    auto const last_piece = block_end_offset <= piece_size(first_piece) ?
+        first_piece :
+        byte_loc(block_loc.byte + block_size(block) - 1).piece;
     for (auto piece = first_piece; piece <= last_piece; ++piece)
     {
         if (!has_piece(piece))
@@ -1172,7 +1222,8 @@ std::string tr_torrentFindFile(tr_torrent const* tor, tr_file_index_t file_num)
 
 size_t tr_torrentFindFileToBuf(tr_torrent const* tor, tr_file_index_t file_num, char* buf, size_t buflen)
 {
-    return tr_strv_to_buf(tr_torrentFindFile(tor, file_num), buf, buflen);
+    auto const found = tor->find_file(file_num);
+    return tr_strv_to_buf(found ? found->filename().sv() : ""sv, buf, buflen);
 }
 
 void tr_torrent::set_download_dir(std::string_view path, bool is_new_torrent)
@@ -1206,8 +1257,10 @@ void tr_torrent::refresh_current_dir()
 {
     auto dir = tr_interned_string{};
 
-    if (std::empty(incomplete_dir()))
+    if (std::empty(incomplete_dir()) || incomplete_dir() == download_dir())
     {
+        // either answer find_file() could give collapses to download_dir(),
+        // so skip the filesystem probe
         dir = download_dir();
     }
     else if (!has_metainfo()) // no files to find
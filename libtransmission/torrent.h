@@ -172,6 +172,10 @@ struct tr_torrent
     private:
         tr_torrent* const tor_;
         std::optional<time_t> time_started_;
+
+        // 1 / piece_count(), cached when verification starts so the
+        // per-piece progress update multiplies instead of divides
+        float inv_piece_count_ = 0.0F;
     };
 
     // ---
@@ -563,6 +567,13 @@ struct tr_torrent
         return !this->is_private();
     }
 
+    // precomputed in on_metainfo_updated() so view/stats polling
+    // doesn't rescan the first file's subpath for a '/' per call
+    [[nodiscard]] constexpr auto is_folder() const noexcept
+    {
+        return is_folder_;
+    }
+
     [[nodiscard]] constexpr auto const& info_hash_string() const noexcept
     {
         return metainfo_.info_hash_string();
@@ -658,6 +669,10 @@ struct tr_torrent
 
     [[nodiscard]] tr_stat stats() const;
 
+    // clock-hoisted flavor for batch polling: lets tr_torrentStat() read
+    // tr_time() / tr_time_msec() once and share them across every torrent
+    [[nodiscard]] tr_stat stats(uint64_t now_msec, time_t now_sec) const;
+
     [[nodiscard]] constexpr auto queue_direction() const noexcept
     {
         return is_done() ? TR_UP : TR_DOWN;
@@ -817,7 +832,7 @@ struct tr_torrent
         if (mode != sequential_download_mode_)
         {
             sequential_download_mode_ = mode;
-            recalculate_file_order();
+            invalidate_file_order();
             set_dirty();
         }
     }
@@ -827,9 +842,12 @@ struct tr_torrent
         return sequential_download_mode_;
     }
 
-    void recalculate_file_order();
+    constexpr void invalidate_file_order() noexcept
+    {
+        file_order_dirty_ = true;
+    }
 
-    [[nodiscard]] tr_piece_index_t file_index_for_piece(tr_piece_index_t piece) const noexcept;
+    [[nodiscard]] tr_piece_index_t file_index_for_piece(tr_piece_index_t piece) const;
 
     // Returns true if file is a video file (for playback priority)
     [[nodiscard]] bool is_video_file(tr_file_index_t file) const noexcept;
@@ -1228,8 +1246,9 @@ private:
         files_wanted_.set(files, n_files, wanted);
         completion_.invalidate_size_when_done();
 
-        // Recalculate file order BEFORE emitting, so observers get updated order
-        recalculate_file_order();
+        // Invalidate BEFORE emitting, so observers asking for the order
+        // get it rebuilt with the new wanted set
+        invalidate_file_order();
         files_wanted_changed_.emit(this, files, n_files, wanted);
 
         if (!is_bootstrapping)
@@ -1316,6 +1335,12 @@ private:
 
     void update_file_path(tr_file_index_t file, std::optional<bool> has_file) const;
 
+    // one-pass flavor for bulk use (e.g. after verify): hoists the
+    // per-file session queries out of the loop
+    void update_all_file_paths() const;
+
+    void update_file_path_impl(tr_file_index_t file, std::optional<bool> has_file, bool incomplete_naming) const;
+
     void set_location_in_session_thread(std::string_view path, bool move_from_old_path, int volatile* setme_state);
 
     void rename_path_in_session_thread(
@@ -1359,6 +1384,10 @@ private:
     // when Transmission thinks the torrent's files were last changed
     std::vector<time_t> file_mtimes_;
 
+    // true iff any entry in file_mtimes_ is positive, maintained by the
+    // resume-time probe so init() doesn't rescan the vector
+    bool file_mtimes_any_positive_ = false;
+
     tr_interned_string bandwidth_group_;
 
     // Where the files are when the torrent is complete.
@@ -1434,20 +1463,51 @@ private:
 
     tr_sequential_mode_t sequential_download_mode_ = TR_SEQUENTIAL_BY_FILE;
 
-    std::vector<tr_piece_index_t> file_index_by_piece_;
+    // Piece-to-file mapping for sequential-by-file downloads, rebuilt
+    // lazily by file_index_for_piece() when marked dirty; mutators just
+    // flip the flag so torrents that never request it skip the sort.
+    mutable std::vector<tr_piece_index_t> file_index_by_piece_;
+    mutable bool file_order_dirty_ = true;
+
+    void recalculate_file_order() const;
 
     // start the torrent after all the startup scaffolding is done,
     // e.g. fetching metadata from peers and/or verifying the torrent
     bool start_when_stable_ = false;
 
-    // Cached consecutive progress per file (playable progress from start)
-    // Updated when pieces complete, -1.0 means not yet calculated
-    mutable std::vector<float> file_consecutive_progress_;
+    // Cached count of consecutive complete pieces per file, from the
+    // file's first piece. Validity is tracked in a separate bitfield so
+    // invalidating a file touches one bit instead of the counts array.
+    mutable std::vector<tr_piece_index_t> file_consecutive_pieces_;
+    mutable tr_bitfield file_consecutive_progress_valid_{ 0U };
+
+    [[nodiscard]] tr_piece_index_t count_consecutive_complete_pieces(tr_piece_index_t begin_piece, tr_piece_index_t end_piece)
+        const;
 
     // True when torrent has both audio-like files and .jpg/.jpeg (album cover) for piece priority.
     // Set in update_piece_priority_state() (torrent-piece-priority.cc).
     bool has_audio_and_cover_ = false;
 
+    // true when the torrent unpacks into a directory rather than a
+    // single file; set in on_metainfo_updated()
+    bool is_folder_ = false;
+
+    // true while a sequential-mode flush is queued on the session
+    // thread, so a burst of piece completions yields a single
+    // flush_torrent_files() call instead of one per piece
+    bool sequential_flush_pending_ = false;
+
+    // Per-file classification bits, also set in update_piece_priority_state().
+    // The piece-priority checks run in request-selection loops, so they test
+    // a cached bit here instead of redoing MIME + extension work per call.
+    tr_bitfield file_is_video_{ 0U };
+    tr_bitfield file_is_priority_{ 0U }; // DVD/Blu-ray index files
+    tr_bitfield file_is_cover_{ 0U }; // .jpg/.jpeg album art
+
+    // Absolute byte offset where each video file's prioritized tail begins;
+    // UINT64_MAX for non-video files so the tail overlap check always fails.
+    std::vector<uint64_t> file_tail_start_;
+
 public:
     // Get consecutive progress for a file (0.0-1.0)
     // This represents how much of the file can be played from the beginning
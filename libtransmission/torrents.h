@@ -34,6 +34,14 @@ public:
 
     void remove(tr_torrent const* tor, time_t current_time);
 
+    // capacity hint, e.g. the number of torrent files about to be
+    // loaded at session startup
+    void reserve(size_t const n_torrents)
+    {
+        by_hash_.reserve(n_torrents);
+        by_id_.reserve(n_torrents + 1U); // by_id_[0] is a sentinel
+    }
+
     // O(1)
     [[nodiscard]] TR_CONSTEXPR20 tr_torrent* get(tr_torrent_id_t id) const
     {
@@ -14,6 +14,8 @@
 #include <string_view>
 #include <vector>
 
+#include <small/vector.hpp>
+
 #ifdef _WIN32
 #include <ws2tcpip.h>
 #else
@@ -91,7 +93,9 @@ public:
     public:
         virtual ~Mediator() = default;
 
-        [[nodiscard]] virtual std::vector<tr_torrent_id_t> torrents_allowing_dht() const = 0;
+        // small-vector since typically only a handful of torrents are
+        // both running and DHT-enabled at any given moment
+        [[nodiscard]] virtual small::vector<tr_torrent_id_t, 64U> torrents_allowing_dht() const = 0;
         [[nodiscard]] virtual tr_sha1_digest_t torrent_info_hash(tr_torrent_id_t) const = 0;
 
         [[nodiscard]] virtual std::string_view config_dir() const = 0;
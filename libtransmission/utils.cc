@@ -813,13 +813,36 @@ std::string_view tr_get_mime_type_for_filename(std::string_view filename)
         return entry.suffix < suffix;
     };
 
+    // longest suffix in MimeTypeSuffixes; anything longer can't match,
+    // and the bound lets us case-fold into a stack buffer instead of
+    // building a lowercased std::string per lookup
+    auto constexpr MaxSuffixLen = []()
+    {
+        auto len = size_t{};
+        for (auto const& [suffix, mime_type] : MimeTypeSuffixes)
+        {
+            len = std::max(len, std::size(suffix));
+        }
+        return len;
+    }();
+
     if (auto const pos = filename.rfind('.'); pos != std::string_view::npos)
     {
-        auto const suffix_lc = tr_strlower(filename.substr(pos + 1));
-        auto const it = std::lower_bound(std::begin(MimeTypeSuffixes), std::end(MimeTypeSuffixes), suffix_lc, Compare);
-        if (it != std::end(MimeTypeSuffixes) && suffix_lc == it->suffix)
+        auto const suffix = filename.substr(pos + 1);
+        if (auto const len = std::size(suffix); len <= MaxSuffixLen)
         {
-            return it->mime_type;
+            auto buf = std::array<char, MaxSuffixLen>{};
+            std::transform(
+                std::begin(suffix),
+                std::end(suffix),
+                std::begin(buf),
+                [](char ch) { return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch; });
+            auto const suffix_lc = std::string_view{ std::data(buf), len };
+            auto const it = std::lower_bound(std::begin(MimeTypeSuffixes), std::end(MimeTypeSuffixes), suffix_lc, Compare);
+            if (it != std::end(MimeTypeSuffixes) && suffix_lc == it->suffix)
+            {
+                return it->mime_type;
+            }
         }
     }
 
@@ -551,9 +551,9 @@ void onTorrentCompletenessChanged(tr_torrent* tor, tr_completeness status, bool
         for (NSDictionary* historyItem in history)
         {
             NSString* hash = historyItem[@"TorrentHash"];
-            if ([self.fTorrentHashes.allKeys containsObject:hash])
+            Torrent* torrent = hash ? self.fTorrentHashes[hash] : nil;
+            if (torrent)
             {
-                Torrent* torrent = self.fTorrentHashes[hash];
                 [t setResumeStatusForTorrent:torrent withHistory:historyItem forcePause:self.fPauseOnLaunch];
 
                 NSNumber* waitToStart;
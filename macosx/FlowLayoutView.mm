@@ -3,6 +3,7 @@
 // License text can be found in the licenses/ folder.
 
 #include <cmath>
+#include <vector>
 
 #import "FlowLayoutView.h"
 
@@ -15,13 +16,19 @@
 
 @interface FlowLayoutView ()
 @property(nonatomic) NSMutableArray<NSView*>* contentViews;
-@property(nonatomic) NSMapTable<NSView*, NSValue*>* cachedSizes;
+@property(nonatomic) NSMutableArray<NSView*>* pendingViews;
 @property(nonatomic) CGFloat lastLayoutWidth;
 @property(nonatomic) CGFloat lastLayoutHeight;
 @property(nonatomic) BOOL layoutDirty;
 @end
 
 @implementation FlowLayoutView
+{
+    // Cached size per contentViews index; width < 0 means "not cached yet".
+    // Parallel to contentViews so the layout sweep reads a packed array
+    // instead of hashing NSView pointers through an NSMapTable per view.
+    std::vector<NSSize> _cachedSizes;
+}
 
 - (void)commonInit
 {
@@ -31,7 +38,7 @@
     self.wantsLayer = NO;
 
     _contentViews = [NSMutableArray array];
-    _cachedSizes = [NSMapTable weakToStrongObjectsMapTable];
+    _pendingViews = [NSMutableArray array];
     _horizontalSpacing = 6;
     _verticalSpacing = 4;
     _minimumButtonWidth = 50;
@@ -61,6 +68,7 @@
 - (void)addArrangedSubview:(NSView*)view
 {
     [_contentViews addObject:view];
+    _cachedSizes.push_back(NSMakeSize(-1, -1));
     [self addSubview:view];
     _layoutDirty = YES;
 }
@@ -68,11 +76,19 @@
 - (void)addArrangedSubviewBatched:(NSView*)view
 {
     [_contentViews addObject:view];
-    [self addSubview:view];
+    _cachedSizes.push_back(NSMakeSize(-1, -1));
+    [_pendingViews addObject:view];
 }
 
 - (void)finishBatchUpdates
 {
+    // Insert the whole batch with one setSubviews: call so AppKit runs a
+    // single view-hierarchy/constraint pass instead of one per addSubview:.
+    if (_pendingViews.count > 0)
+    {
+        self.subviews = [self.subviews arrayByAddingObjectsFromArray:_pendingViews];
+        [_pendingViews removeAllObjects];
+    }
     _layoutDirty = YES;
     [self setNeedsLayout:YES];
 }
@@ -81,6 +97,7 @@
 {
     FlowLineBreak* br = [[FlowLineBreak alloc] init];
     [_contentViews addObject:br];
+    _cachedSizes.push_back(NSMakeSize(-1, -1));
     [self addSubview:br];
     _layoutDirty = YES;
 }
@@ -89,7 +106,8 @@
 {
     FlowLineBreak* br = [[FlowLineBreak alloc] init];
     [_contentViews addObject:br];
-    [self addSubview:br];
+    _cachedSizes.push_back(NSMakeSize(-1, -1));
+    [_pendingViews addObject:br];
 }
 
 - (NSArray<NSView*>*)contentSubviews
@@ -104,19 +122,20 @@
     for (NSView* v in _contentViews)
         [v removeFromSuperview];
     [_contentViews removeAllObjects];
-    [_cachedSizes removeAllObjects];
+    [_pendingViews removeAllObjects];
+    _cachedSizes.clear();
     _layoutDirty = YES;
     _lastLayoutWidth = 0;
     _lastLayoutHeight = 0;
     [self invalidateIntrinsicContentSize];
 }
 
-- (NSSize)sizeForView:(NSView*)view
+- (NSSize)sizeAtIndex:(NSUInteger)index
 {
-    NSValue* cached = [_cachedSizes objectForKey:view];
-    if (cached)
-        return cached.sizeValue;
-    NSSize size;
+    NSSize size = _cachedSizes[index];
+    if (size.width >= 0)
+        return size;
+    NSView* view = _contentViews[index];
     if ([view isKindOfClass:[NSButton class]])
     {
         size = view.intrinsicContentSize;
@@ -128,44 +147,46 @@
         size = view.fittingSize;
     if (size.width <= 0) size.width = 60;
     if (size.height <= 0) size.height = 18;
-    [_cachedSizes setObject:[NSValue valueWithSize:size] forKey:view];
+    _cachedSizes[index] = size;
     return size;
 }
 
-- (NSArray<NSArray<NSView*>*>*)rowsForWidth:(CGFloat)width
+- (std::vector<std::vector<NSUInteger>>)rowsForWidth:(CGFloat)width
 {
-    NSMutableArray<NSArray<NSView*>*>* rows = [NSMutableArray array];
-    NSMutableArray<NSView*>* currentRow = [NSMutableArray array];
+    std::vector<std::vector<NSUInteger>> rows;
+    std::vector<NSUInteger> currentRow;
     CGFloat x = 0;
 
-    for (NSView* v in _contentViews)
+    NSUInteger const count = _contentViews.count;
+    for (NSUInteger i = 0; i < count; ++i)
     {
+        NSView* v = _contentViews[i];
         if ([v isKindOfClass:[FlowLineBreak class]])
         {
-            if (currentRow.count > 0)
+            if (!currentRow.empty())
             {
-                [rows addObject:[currentRow copy]];
-                [currentRow removeAllObjects];
+                rows.push_back(currentRow);
+                currentRow.clear();
             }
             x = 0;
             continue;
         }
         if (v.hidden)
             continue;
-        CGFloat w = [self sizeForView:v].width;
-        BOOL overflow = (x + w > width + 0.001) && currentRow.count > 0;
-        BOOL atCap = _maximumColumnCount > 0 && currentRow.count >= _maximumColumnCount;
-        if ((overflow || atCap) && currentRow.count > 0)
+        CGFloat w = [self sizeAtIndex:i].width;
+        BOOL overflow = (x + w > width + 0.001) && !currentRow.empty();
+        BOOL atCap = _maximumColumnCount > 0 && currentRow.size() >= _maximumColumnCount;
+        if (overflow || atCap)
         {
-            [rows addObject:[currentRow copy]];
-            [currentRow removeAllObjects];
+            rows.push_back(currentRow);
+            currentRow.clear();
             x = 0;
         }
-        [currentRow addObject:v];
+        currentRow.push_back(i);
         x += w + _horizontalSpacing;
     }
-    if (currentRow.count > 0)
-        [rows addObject:currentRow];
+    if (!currentRow.empty())
+        rows.push_back(currentRow);
     return rows;
 }
 
@@ -174,7 +195,7 @@
     if (width <= 0) return;
     if (!_layoutDirty && std::fabs(width - _lastLayoutWidth) < 0.001) return;
 
-    NSArray<NSArray<NSView*>*>* rows = [self rowsForWidth:width];
+    auto const rows = [self rowsForWidth:width];
     CGFloat y = 0;
 
     for (NSView* v in _contentViews)
@@ -183,15 +204,16 @@
             v.hidden = YES;
             v.frame = NSZeroRect;
         }
-    for (NSArray* row in rows)
+    for (auto const& row : rows)
     {
         CGFloat rowH = 0;
-        for (NSView* v in row)
-            rowH = MAX(rowH, [self sizeForView:v].height);
+        for (auto const i : row)
+            rowH = MAX(rowH, [self sizeAtIndex:i].height);
         CGFloat x = 0;
-        for (NSView* v in row)
+        for (auto const i : row)
         {
-            NSSize sz = [self sizeForView:v];
+            NSSize sz = _cachedSizes[i]; // warm: the rowH pass above filled it
+            NSView* v = _contentViews[i];
             v.hidden = NO;
             CGFloat vY = y + (rowH - sz.height) / 2.0;
             NSRect newFrame = NSMakeRect(x, vY, sz.width, sz.height);
@@ -203,7 +225,7 @@
         y += rowH + _verticalSpacing;
     }
 
-    _lastLayoutHeight = rows.count > 0 ? y - _verticalSpacing : 0;
+    _lastLayoutHeight = !rows.empty() ? y - _verticalSpacing : 0;
     _layoutDirty = NO;
     _lastLayoutWidth = width;
 }
@@ -251,7 +273,9 @@
 
 - (void)invalidateSizeForView:(NSView*)view
 {
-    [_cachedSizes removeObjectForKey:view];
+    NSUInteger const index = [_contentViews indexOfObjectIdenticalTo:view];
+    if (index != NSNotFound)
+        _cachedSizes[index] = NSMakeSize(-1, -1);
     _layoutDirty = YES;
 }
 
@@ -6,9 +6,16 @@
 
 #import <Foundation/Foundation.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <atomic>
+#include <charconv>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -81,52 +88,103 @@ struct OutlineBuildResult
 
 inline OutlineBuildResult buildOutlineItems(std::vector<PdfOutlineItem>* items, std::vector<OutlineNode> const& nodes, int parent)
 {
-    OutlineBuildResult result;
-    int prev = -1;
-
-    for (auto const& node : nodes)
+    // Count the total first so the items vector is sized once, then walk
+    // the tree with an explicit stack: no mid-recursion reallocations and
+    // no stack growth on deeply nested tables of contents.
+    size_t total = 0;
+    std::vector<std::vector<OutlineNode> const*> countStack{ &nodes };
+    while (!countStack.empty())
     {
-        int const idx = (int)items->size();
-        items->push_back({ node.title, node.pageIndex, parent });
-
-        if (result.first == -1)
-            result.first = idx;
-        if (prev != -1)
+        auto const* level = countStack.back();
+        countStack.pop_back();
+        total += level->size();
+        for (auto const& node : *level)
         {
-            (*items)[prev].next = idx;
-            (*items)[idx].prev = prev;
+            if (!node.children.empty())
+                countStack.push_back(&node.children);
         }
-        prev = idx;
+    }
+    items->reserve(items->size() + total);
 
-        OutlineBuildResult childResult;
-        if (!node.children.empty())
+    struct Frame
+    {
+        std::vector<OutlineNode> const* nodes;
+        size_t next;
+        int parent;
+        int prev;
+        OutlineBuildResult result;
+    };
+
+    OutlineBuildResult topResult;
+    std::vector<Frame> stack;
+    stack.push_back({ &nodes, 0, parent, -1, {} });
+    while (!stack.empty())
+    {
+        Frame& frame = stack.back();
+        if (frame.next < frame.nodes->size())
         {
-            childResult = buildOutlineItems(items, node.children, idx);
-            (*items)[idx].firstChild = childResult.first;
-            (*items)[idx].lastChild = childResult.last;
-            (*items)[idx].count = childResult.descendants;
-        }
+            auto const& node = (*frame.nodes)[frame.next++];
+            int const idx = (int)items->size();
+            items->push_back({ node.title, node.pageIndex, frame.parent });
+
+            if (frame.result.first == -1)
+                frame.result.first = idx;
+            if (frame.prev != -1)
+            {
+                (*items)[frame.prev].next = idx;
+                (*items)[idx].prev = frame.prev;
+            }
+            frame.prev = idx;
+            frame.result.last = idx;
+            frame.result.descendants += 1; // subtree sizes are added when child frames finish
 
-        result.last = idx;
-        result.descendants += 1 + (*items)[idx].count;
+            if (!node.children.empty())
+                stack.push_back({ &node.children, 0, idx, -1, {} });
+        }
+        else
+        {
+            OutlineBuildResult const done = frame.result;
+            int const ownerIdx = frame.parent;
+            stack.pop_back();
+            if (!stack.empty())
+            {
+                (*items)[ownerIdx].firstChild = done.first;
+                (*items)[ownerIdx].lastChild = done.last;
+                (*items)[ownerIdx].count = done.descendants;
+                stack.back().result.descendants += done.descendants;
+            }
+            else
+                topResult = done;
+        }
     }
 
-    return result;
+    return topResult;
 }
 
 inline std::string pdfEscapeString(std::string_view text)
 {
+    // Most text has nothing to escape, so copy clean runs in bulk and only
+    // drop to per-character handling at the bytes that need a backslash.
+    static constexpr char NeedsEscape[] = "\\()\n\r\t";
     std::string out;
     out.reserve(text.size() + 8);
-    for (unsigned char ch : text)
+    size_t pos = 0;
+    while (pos < text.size())
     {
-        switch (ch)
+        size_t const dirty = text.find_first_of(NeedsEscape, pos);
+        if (dirty == std::string_view::npos)
+        {
+            out.append(text, pos, std::string_view::npos);
+            break;
+        }
+        out.append(text, pos, dirty - pos);
+        switch (text[dirty])
         {
         case '\\':
         case '(':
         case ')':
             out.push_back('\\');
-            out.push_back((char)ch);
+            out.push_back(text[dirty]);
             break;
         case '\n':
             out.append("\\n");
@@ -134,26 +192,45 @@ inline std::string pdfEscapeString(std::string_view text)
         case '\r':
             out.append("\\r");
             break;
-        case '\t':
+        default: // '\t'
             out.append("\\t");
             break;
-        default:
-            out.push_back((char)ch);
-            break;
         }
+        pos = dirty + 1;
     }
     return out;
 }
 
-inline void appendHexByte(std::string* out, unsigned char value)
+// Precomputed byte -> two-hex-digit pairs so the UTF-16BE encoder stores
+// two characters per input byte with one memcpy instead of two push_backs.
+struct PdfHexPairs
+{
+    char pairs[512];
+};
+
+inline constexpr PdfHexPairs makePdfHexPairs()
 {
-    static char constexpr Hex[] = "0123456789ABCDEF";
-    out->push_back(Hex[value >> 4]);
-    out->push_back(Hex[value & 0x0F]);
+    char constexpr Hex[] = "0123456789ABCDEF";
+    PdfHexPairs result{};
+    for (int i = 0; i < 256; ++i)
+    {
+        result.pairs[2 * i] = Hex[i >> 4];
+        result.pairs[2 * i + 1] = Hex[i & 0x0F];
+    }
+    return result;
 }
 
+inline constexpr PdfHexPairs PdfHex = makePdfHexPairs();
+
 inline std::string pdfOutlineTitle(std::string_view text)
 {
+    // ASCII titles don't need the NSString -> UTF-16BE -> hex round trip;
+    // the escaped literal form is equivalent (ASCII is a subset of
+    // PDFDocEncoding) and skips two allocations and a transcode.
+    bool const isAscii = std::all_of(text.begin(), text.end(), [](char ch) { return (unsigned char)ch < 0x80; });
+    if (isAscii)
+        return "(" + pdfEscapeString(text) + ")";
+
     NSString* ns = [[NSString alloc] initWithBytes:text.data() length:text.size() encoding:NSUTF8StringEncoding];
     if (ns == nil)
         return "(" + pdfEscapeString(text) + ")";
@@ -167,8 +244,11 @@ inline std::string pdfOutlineTitle(std::string_view text)
     out.push_back('<');
     out.append("FEFF");
     unsigned char const* bytes = static_cast<unsigned char const*>(data.bytes);
+    size_t const hexStart = out.size();
+    out.resize(hexStart + (size_t)data.length * 2);
+    char* dst = &out[hexStart];
     for (NSUInteger i = 0; i < data.length; ++i)
-        appendHexByte(&out, bytes[i]);
+        std::memcpy(dst + 2 * i, &PdfHex.pairs[2 * bytes[i]], 2);
     out.push_back('>');
     return out;
 }
@@ -198,8 +278,10 @@ struct IncrementalPdfWriter
     std::vector<int> outlineObjs;
     OutlineBuildResult outlineResult;
     std::unordered_map<std::string, std::string> metadata;
+    std::unordered_map<std::string, std::string> outlineTitleCache; // Memoized pdfOutlineTitle tokens
     mutable std::mutex writeMutex; // Protect file writes
-    std::vector<bool> pagesWritten; // Track which pages have been written
+    std::vector<uint8_t> pagesWritten; // Track which pages have been written (byte per page, no bit-packed RMW)
+    std::atomic<size_t> pagesWrittenCount{ 0 }; // Lock-free completion check
     bool initialized = false;
     std::atomic<bool> finalized{ false }; // Track if PDF has been finalized
 
@@ -208,6 +290,36 @@ struct IncrementalPdfWriter
         buffer_.insert(buffer_.end(), s.data(), s.data() + s.size());
     }
 
+    // Direct integer emitters for the hot object-header/xref paths;
+    // std::to_chars skips vsnprintf's format-string parsing and the
+    // intermediate stack-buffer copy. appendFmt stays for %g floats.
+    void appendInt(int value)
+    {
+        char tmp[16];
+        auto const res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        buffer_.insert(buffer_.end(), tmp, res.ptr);
+    }
+
+    void appendU64(uint64_t value)
+    {
+        char tmp[20];
+        auto const res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        buffer_.insert(buffer_.end(), tmp, res.ptr);
+    }
+
+    // Fixed-width zero-padded emitter for xref entries ("%010llu").
+    void appendU64Padded10(uint64_t value)
+    {
+        char tmp[10];
+        std::memset(tmp, '0', sizeof(tmp));
+        char digits[20];
+        auto const res = std::to_chars(digits, digits + sizeof(digits), value);
+        size_t const n = (size_t)(res.ptr - digits);
+        if (n <= sizeof(tmp))
+            std::memcpy(tmp + sizeof(tmp) - n, digits, n);
+        buffer_.insert(buffer_.end(), tmp, tmp + sizeof(tmp));
+    }
+
     void appendFmt(char const* fmt, ...)
     {
         char stack[2048];
@@ -235,6 +347,15 @@ struct IncrementalPdfWriter
             buffer_.insert(buffer_.end(), bytes, bytes + len);
     }
 
+    // Grow capacity geometrically ahead of a large append so repeated page
+    // writes don't each pay an exact-fit reallocation (and full-buffer copy).
+    void reserveFor(size_t more)
+    {
+        size_t const needed = buffer_.size() + more;
+        if (needed > buffer_.capacity())
+            buffer_.reserve(std::max(needed, buffer_.capacity() * 2U));
+    }
+
     bool init(
         int pageCount,
         std::vector<std::vector<uint8_t>> const& jbig2Globals,
@@ -248,7 +369,8 @@ struct IncrementalPdfWriter
         buffer_.clear();
         metadata = meta;
         pageObjs.resize((size_t)pageCount);
-        pagesWritten.resize((size_t)pageCount, false);
+        pagesWritten.assign((size_t)pageCount, 0);
+        pagesWrittenCount.store(0, std::memory_order_relaxed);
 
         appendStr("%PDF-1.7\n%\xE2\xE3\xCF\xD3\n");
 
@@ -293,14 +415,33 @@ struct IncrementalPdfWriter
         int const objCount = nextObj - 1;
         offsets.resize((size_t)objCount + 1U, 0);
 
+        // Pre-size the buffer for the structural parts: per-page dict and
+        // contents overhead, outline objects, and a header/xref allowance.
+        // Image payloads aren't known yet — writePage reserves for those.
+        size_t estimated = 64U * 1024U + (size_t)pageCount * 4096U + outlineItems.size() * 256U;
+        for (auto const& globals : jbig2Globals)
+            estimated += globals.size() + 256U;
+        buffer_.reserve(estimated);
+
         initialized = true;
         return true;
     }
 
+    // Outlines often repeat section titles (and metadata fields recur
+    // across writeField probes), so memoize the encoded tokens.
+    std::string const& outlineTitleToken(std::string const& text)
+    {
+        auto it = outlineTitleCache.find(text);
+        if (it == outlineTitleCache.end())
+            it = outlineTitleCache.emplace(text, pdfOutlineTitle(text)).first;
+        return it->second;
+    }
+
     void writeObjBegin(int objNum)
     {
         offsets[(size_t)objNum] = (uint64_t)buffer_.size();
-        appendFmt("%d 0 obj\n", objNum);
+        appendInt(objNum);
+        appendStr(" 0 obj\n");
     }
 
     void writeObjEnd()
@@ -311,7 +452,10 @@ struct IncrementalPdfWriter
     void writeStreamObj(int objNum, char const* dictPrefix, uint8_t const* bytes, size_t len)
     {
         writeObjBegin(objNum);
-        appendFmt("%s/Length %zu >>\nstream\n", dictPrefix, len);
+        appendStr(dictPrefix);
+        appendStr("/Length ");
+        appendU64(len);
+        appendStr(" >>\nstream\n");
         appendBytes(bytes, len);
         appendStr("\nendstream\n");
         writeObjEnd();
@@ -325,9 +469,12 @@ struct IncrementalPdfWriter
         std::lock_guard<std::mutex> lock(writeMutex);
 
         // Skip if page already written
-        if ((size_t)pageIndex < pagesWritten.size() && pagesWritten[(size_t)pageIndex])
+        if ((size_t)pageIndex < pagesWritten.size() && pagesWritten[(size_t)pageIndex] != 0)
             return true;
 
+        // One reservation covers this page's image payloads plus dict overhead
+        reserveFor(p.image.bytes.size() + p.bgImage.bytes.size() + p.fgMask.bytes.size() + 1024U);
+
         PageObjs& o = pageObjs[(size_t)pageIndex];
         bool const isCompound =
             (p.bgImage.kind != DjvuPdfImageKind::None && !p.bgImage.bytes.empty() && p.fgMask.kind != DjvuPdfImageKind::None &&
@@ -351,12 +498,15 @@ struct IncrementalPdfWriter
             DjvuPdfImageInfo const& bgImg = p.bgImage;
             writeObjBegin(o.bgImg);
             char const* bgCs = bgImg.gray ? "/DeviceGray" : "/DeviceRGB";
-            appendFmt(
-                "<< /Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace %s /BitsPerComponent 8 /Filter /DCTDecode /Length %zu >>\nstream\n",
-                bgImg.w,
-                bgImg.h,
-                bgCs,
-                (size_t)bgImg.bytes.size());
+            appendStr("<< /Type /XObject /Subtype /Image /Width ");
+            appendInt(bgImg.w);
+            appendStr(" /Height ");
+            appendInt(bgImg.h);
+            appendStr(" /ColorSpace ");
+            appendStr(bgCs);
+            appendStr(" /BitsPerComponent 8 /Filter /DCTDecode /Length ");
+            appendU64(bgImg.bytes.size());
+            appendStr(" >>\nstream\n");
             appendBytes(bgImg.bytes.data(), bgImg.bytes.size());
             appendStr("\nendstream\n");
             writeObjEnd();
@@ -368,12 +518,15 @@ struct IncrementalPdfWriter
             if (fgGlobalsObj == 0)
                 return false;
             writeObjBegin(o.fgMask);
-            appendFmt(
-                "<< /Type /XObject /Subtype /Image /Width %d /Height %d /ImageMask true /BitsPerComponent 1 /Filter /JBIG2Decode /DecodeParms << /JBIG2Globals %d 0 R >> /Length %zu >>\nstream\n",
-                fgMask.w,
-                fgMask.h,
-                fgGlobalsObj,
-                (size_t)fgMask.bytes.size());
+            appendStr("<< /Type /XObject /Subtype /Image /Width ");
+            appendInt(fgMask.w);
+            appendStr(" /Height ");
+            appendInt(fgMask.h);
+            appendStr(" /ImageMask true /BitsPerComponent 1 /Filter /JBIG2Decode /DecodeParms << /JBIG2Globals ");
+            appendInt(fgGlobalsObj);
+            appendStr(" 0 R >> /Length ");
+            appendU64(fgMask.bytes.size());
+            appendStr(" >>\nstream\n");
             appendBytes(fgMask.bytes.data(), fgMask.bytes.size());
             appendStr("\nendstream\n");
             writeObjEnd();
@@ -385,12 +538,15 @@ struct IncrementalPdfWriter
             if (img.kind == DjvuPdfImageKind::Jpeg)
             {
                 char const* cs = img.gray ? "/DeviceGray" : "/DeviceRGB";
-                appendFmt(
-                    "<< /Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace %s /BitsPerComponent 8 /Filter /DCTDecode /Length %zu >>\nstream\n",
-                    img.w,
-                    img.h,
-                    cs,
-                    (size_t)img.bytes.size());
+                appendStr("<< /Type /XObject /Subtype /Image /Width ");
+                appendInt(img.w);
+                appendStr(" /Height ");
+                appendInt(img.h);
+                appendStr(" /ColorSpace ");
+                appendStr(cs);
+                appendStr(" /BitsPerComponent 8 /Filter /DCTDecode /Length ");
+                appendU64(img.bytes.size());
+                appendStr(" >>\nstream\n");
             }
             else if (img.kind == DjvuPdfImageKind::Jbig2)
             {
@@ -405,40 +561,46 @@ struct IncrementalPdfWriter
                     writeObjEnd();
                     return false;
                 }
-                appendFmt(
-                    "<< /Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace /DeviceGray /BitsPerComponent 1 /Filter /JBIG2Decode /DecodeParms << /JBIG2Globals %d 0 R >> /Length %zu >>\nstream\n",
-                    img.w,
-                    img.h,
-                    globalsObj,
-                    (size_t)img.bytes.size());
+                appendStr("<< /Type /XObject /Subtype /Image /Width ");
+                appendInt(img.w);
+                appendStr(" /Height ");
+                appendInt(img.h);
+                appendStr(" /ColorSpace /DeviceGray /BitsPerComponent 1 /Filter /JBIG2Decode /DecodeParms << /JBIG2Globals ");
+                appendInt(globalsObj);
+                appendStr(" 0 R >> /Length ");
+                appendU64(img.bytes.size());
+                appendStr(" >>\nstream\n");
             }
             appendBytes(img.bytes.data(), img.bytes.size());
             appendStr("\nendstream\n");
             writeObjEnd();
         }
 
-        // Page contents
-        std::string contents;
-        contents.reserve(256);
+        // Page contents: emit straight into buffer_ and backpatch the stream
+        // length afterwards, skipping the snprintf -> std::string -> buffer_
+        // copy chain. A zero-padded /Length is still a valid PDF integer.
+        writeObjBegin(o.contents);
+        appendStr("<< /Length ");
+        size_t const lengthAt = buffer_.size();
+        appendStr("0000000000 >>\nstream\n");
+        size_t const streamStart = buffer_.size();
         if (isCompound)
         {
             DjvuPdfImageInfo const& bgImg = p.bgImage;
             DjvuPdfImageInfo const& fgMask = p.fgMask;
-            char tmp[256];
-            snprintf(tmp, sizeof(tmp), "q\n%g 0 0 %g %g %g cm\n/BgIm Do\nQ\n", bgImg.pdfW, bgImg.pdfH, bgImg.x, bgImg.y);
-            contents.append(tmp);
-            snprintf(tmp, sizeof(tmp), "q\n0 g\n%g 0 0 %g %g %g cm\n/FgMask Do\nQ\n", fgMask.pdfW, fgMask.pdfH, fgMask.x, fgMask.y);
-            contents.append(tmp);
+            appendFmt("q\n%g 0 0 %g %g %g cm\n/BgIm Do\nQ\n", bgImg.pdfW, bgImg.pdfH, bgImg.x, bgImg.y);
+            appendFmt("q\n0 g\n%g 0 0 %g %g %g cm\n/FgMask Do\nQ\n", fgMask.pdfW, fgMask.pdfH, fgMask.x, fgMask.y);
         }
         else if (o.img != 0)
         {
             DjvuPdfImageInfo const& img = p.image;
-            char tmp[256];
-            snprintf(tmp, sizeof(tmp), "q\n%g 0 0 %g %g %g cm\n/Im Do\nQ\n", img.pdfW, img.pdfH, img.x, img.y);
-            contents.append(tmp);
+            appendFmt("q\n%g 0 0 %g %g %g cm\n/Im Do\nQ\n", img.pdfW, img.pdfH, img.x, img.y);
         }
-
-        writeStreamObj(o.contents, "<< ", (uint8_t const*)contents.data(), contents.size());
+        char lenDigits[11];
+        snprintf(lenDigits, sizeof(lenDigits), "%010zu", buffer_.size() - streamStart);
+        std::memcpy(buffer_.data() + lengthAt, lenDigits, 10);
+        appendStr("\nendstream\n");
+        writeObjEnd();
 
         writeObjBegin(o.page);
         appendFmt("<< /Type /Page /Parent %d 0 R /MediaBox [0 0 %g %g] ", pagesObj, p.pdfWidth, p.pdfHeight);
@@ -459,25 +621,23 @@ struct IncrementalPdfWriter
         writeObjEnd();
 
         // Mark page as written
-        if ((size_t)pageIndex < pagesWritten.size())
-            pagesWritten[(size_t)pageIndex] = true;
+        if ((size_t)pageIndex < pagesWritten.size() && pagesWritten[(size_t)pageIndex] == 0)
+        {
+            pagesWritten[(size_t)pageIndex] = 1;
+            pagesWrittenCount.fetch_add(1, std::memory_order_release);
+        }
 
         return true;
     }
 
-    // Check if all pages are written
+    // Check if all pages are written (lock-free: compares the written
+    // count against the page count instead of scanning under the mutex)
     bool allPagesWritten() const
     {
         if (!initialized || pagesWritten.empty())
             return false;
 
-        std::lock_guard<std::mutex> lock(writeMutex);
-        for (bool written : pagesWritten)
-        {
-            if (!written)
-                return false;
-        }
-        return true;
+        return pagesWrittenCount.load(std::memory_order_acquire) == pagesWritten.size();
     }
 
     // Check if PDF has been finalized
@@ -505,9 +665,15 @@ struct IncrementalPdfWriter
         for (size_t i = 0; i < pageObjs.size(); ++i)
         {
             if (pageObjs[i].page != 0)
-                appendFmt(" %d 0 R", pageObjs[i].page);
+            {
+                appendStr(" ");
+                appendInt(pageObjs[i].page);
+                appendStr(" 0 R");
+            }
         }
-        appendFmt(" ] /Count %zu >>\n", pageObjs.size());
+        appendStr(" ] /Count ");
+        appendU64(pageObjs.size());
+        appendStr(" >>\n");
         writeObjEnd();
 
         if (outlinesObj != 0)
@@ -530,7 +696,7 @@ struct IncrementalPdfWriter
                 int pageIndex = item.pageIndex;
                 if (pageIndex < 0 || (size_t)pageIndex >= pageObjs.size())
                     pageIndex = 0;
-                std::string const titleToken = pdfOutlineTitle(item.title);
+                std::string const& titleToken = outlineTitleToken(item.title);
                 writeObjBegin(outlineObjs[i]);
                 appendFmt(
                     "<< /Title %s /Parent %d 0 R /Dest [%d 0 R /Fit]",
@@ -538,9 +704,17 @@ struct IncrementalPdfWriter
                     parentObj,
                     pageObjs[(size_t)pageIndex].page);
                 if (item.prev != -1)
-                    appendFmt(" /Prev %d 0 R", outlineObjs[(size_t)item.prev]);
+                {
+                    appendStr(" /Prev ");
+                    appendInt(outlineObjs[(size_t)item.prev]);
+                    appendStr(" 0 R");
+                }
                 if (item.next != -1)
-                    appendFmt(" /Next %d 0 R", outlineObjs[(size_t)item.next]);
+                {
+                    appendStr(" /Next ");
+                    appendInt(outlineObjs[(size_t)item.next]);
+                    appendStr(" 0 R");
+                }
                 if (item.firstChild != -1)
                     appendFmt(
                         " /First %d 0 R /Last %d 0 R /Count %d",
@@ -566,7 +740,7 @@ struct IncrementalPdfWriter
             auto it = metadata.find(djvuKey);
             if (it != metadata.end())
             {
-                appendFmt("%s %s ", pdfKey, pdfOutlineTitle(it->second).c_str());
+                appendFmt("%s %s ", pdfKey, outlineTitleToken(it->second).c_str());
                 return true;
             }
             return false;
@@ -588,7 +762,7 @@ struct IncrementalPdfWriter
             if (knownKeys.find(key) == knownKeys.end())
             {
                 std::string const customKey = "/" + pdfEscapeString(key);
-                appendFmt("%s %s ", customKey.c_str(), pdfOutlineTitle(value).c_str());
+                appendFmt("%s %s ", customKey.c_str(), outlineTitleToken(value).c_str());
             }
         }
         appendStr(">>\n");
@@ -596,15 +770,28 @@ struct IncrementalPdfWriter
 
         uint64_t const xrefOffset = (uint64_t)buffer_.size();
         int const objCount = nextObj - 1;
-        appendFmt("xref\n0 %d\n0000000000 65535 f \n", objCount + 1);
+        appendStr("xref\n0 ");
+        appendInt(objCount + 1);
+        appendStr("\n0000000000 65535 f \n");
         for (int i = 1; i <= objCount; ++i)
         {
             if ((size_t)i < offsets.size() && offsets[(size_t)i] != 0)
-                appendFmt("%010llu 00000 n \n", (unsigned long long)offsets[(size_t)i]);
+            {
+                appendU64Padded10(offsets[(size_t)i]);
+                appendStr(" 00000 n \n");
+            }
             else
                 appendStr("0000000000 00000 n \n");
         }
-        appendFmt("trailer\n<< /Size %d /Root %d 0 R /Info %d 0 R >>\nstartxref\n%llu\n%%%%EOF\n", objCount + 1, catalogObj, infoObj, (unsigned long long)xrefOffset);
+        appendStr("trailer\n<< /Size ");
+        appendInt(objCount + 1);
+        appendStr(" /Root ");
+        appendInt(catalogObj);
+        appendStr(" 0 R /Info ");
+        appendInt(infoObj);
+        appendStr(" 0 R >>\nstartxref\n");
+        appendU64(xrefOffset);
+        appendStr("\n%%EOF\n");
         finalized = true;
         return true;
     }
@@ -617,11 +804,37 @@ struct IncrementalPdfWriter
         char const* utf8 = [path UTF8String];
         if (!utf8)
             return false;
-        FILE* f = fopen(utf8, "wb");
-        if (!f)
+        int const fd = open(utf8, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
             return false;
-        bool ok = fwrite(buffer_.data(), 1, buffer_.size(), f) == buffer_.size();
-        fclose(f);
+
+        // Ask the filesystem for the extents up front — contiguous first,
+        // any placement as fallback — then write() directly so the buffer
+        // isn't copied a second time through stdio.
+        fstore_t store = { F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)buffer_.size(), 0 };
+        if (fcntl(fd, F_PREALLOCATE, &store) == -1)
+        {
+            store.fst_flags = F_ALLOCATEALL;
+            fcntl(fd, F_PREALLOCATE, &store);
+        }
+
+        bool ok = true;
+        uint8_t const* data = buffer_.data();
+        size_t remaining = buffer_.size();
+        while (remaining > 0)
+        {
+            ssize_t const n = write(fd, data, remaining);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                ok = false;
+                break;
+            }
+            data += n;
+            remaining -= (size_t)n;
+        }
+        close(fd);
         if (!ok && utf8[0] != '\0')
             remove(utf8);
         return ok;
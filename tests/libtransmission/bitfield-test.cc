@@ -494,3 +494,72 @@ TEST(Bitfield, intersects)
     EXPECT_TRUE(a.intersects(b));
     EXPECT_TRUE(b.intersects(a));
 }
+
+TEST(Bitfield, findFirstUnset)
+{
+    auto bf = tr_bitfield{ 128U };
+
+    // the flag bytes are only allocated up to the highest bit set,
+    // so bits past them must still scan as unset
+    bf.set_span(0U, 64U);
+    EXPECT_EQ(64U, bf.find_first_unset(0U, 128U));
+    EXPECT_EQ(64U, bf.find_first_unset(64U, 128U));
+    EXPECT_EQ(100U, bf.find_first_unset(100U, 128U));
+
+    // unset bit inside the allocated bytes
+    bf.set_has_none();
+    bf.set_span(0U, 10U);
+    bf.set_span(11U, 20U);
+    EXPECT_EQ(10U, bf.find_first_unset(0U, 128U));
+    EXPECT_EQ(10U, bf.find_first_unset(5U, 128U));
+    EXPECT_EQ(20U, bf.find_first_unset(11U, 128U));
+
+    // all bits in the range are set: returns the clamped end
+    EXPECT_EQ(10U, bf.find_first_unset(0U, 10U));
+
+    // end is clamped to size()
+    bf.set_has_all();
+    EXPECT_EQ(128U, bf.find_first_unset(0U, 1000U));
+    EXPECT_EQ(128U, bf.find_first_unset(128U, 1000U));
+
+    // has-all and has-none modes
+    EXPECT_EQ(128U, bf.find_first_unset(64U, 128U));
+    bf.set_has_none();
+    EXPECT_EQ(5U, bf.find_first_unset(5U, 128U));
+
+    // empty range
+    EXPECT_EQ(10U, bf.find_first_unset(10U, 10U));
+}
+
+TEST(Bitfield, findFirstSet)
+{
+    auto bf = tr_bitfield{ 128U };
+
+    // no set bits at all: returns the clamped end
+    EXPECT_EQ(128U, bf.find_first_set(0U, 128U));
+    EXPECT_EQ(128U, bf.find_first_set(0U, 1000U));
+
+    bf.set(70U);
+    EXPECT_EQ(70U, bf.find_first_set(0U, 128U));
+    EXPECT_EQ(70U, bf.find_first_set(70U, 128U));
+    EXPECT_EQ(128U, bf.find_first_set(71U, 128U));
+
+    bf.set(5U);
+    EXPECT_EQ(5U, bf.find_first_set(0U, 128U));
+    EXPECT_EQ(70U, bf.find_first_set(6U, 128U));
+
+    // scanning past the allocated flag bytes finds nothing
+    bf.set_has_none();
+    bf.set(3U);
+    EXPECT_EQ(128U, bf.find_first_set(64U, 128U));
+    EXPECT_EQ(128U, bf.find_first_set(4U, 1000U));
+
+    // has-all and has-none modes
+    bf.set_has_all();
+    EXPECT_EQ(5U, bf.find_first_set(5U, 128U));
+    bf.set_has_none();
+    EXPECT_EQ(128U, bf.find_first_set(5U, 128U));
+
+    // empty range
+    EXPECT_EQ(10U, bf.find_first_set(10U, 10U));
+}
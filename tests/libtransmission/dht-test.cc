@@ -338,7 +338,7 @@ protected:
         {
         }
 
-        [[nodiscard]] std::vector<tr_torrent_id_t> torrents_allowing_dht() const override
+        [[nodiscard]] small::vector<tr_torrent_id_t, 64U> torrents_allowing_dht() const override
         {
             return torrents_allowing_dht_;
         }
@@ -373,7 +373,7 @@ protected:
         }
 
         std::string config_dir_;
-        std::vector<tr_torrent_id_t> torrents_allowing_dht_;
+        small::vector<tr_torrent_id_t, 64U> torrents_allowing_dht_;
         std::map<tr_torrent_id_t, tr_sha1_digest_t> info_hashes_;
         MockDht mock_dht_;
         MockTimerMaker mock_timer_maker_;
@@ -27,6 +27,7 @@ protected:
         mutable std::map<tr_piece_index_t, tr_priority_t> piece_priority_;
         mutable std::map<tr_piece_index_t, size_t> piece_replication_;
         mutable std::set<tr_block_index_t> client_has_block_;
+        mutable tr_bitfield client_blocks_bitfield_{ 0 };
         mutable std::set<tr_piece_index_t> client_has_piece_;
         mutable std::set<tr_piece_index_t> client_wants_piece_;
         bool is_sequential_download_ = false;
@@ -44,6 +45,23 @@ protected:
             return client_has_block_.count(block) != 0;
         }
 
+        [[nodiscard]] tr_bitfield const& client_blocks() const override
+        {
+            auto n_blocks = size_t{};
+            for (auto const& [piece, span] : block_span_)
+            {
+                n_blocks = std::max(n_blocks, size_t{ span.end });
+            }
+
+            client_blocks_bitfield_ = tr_bitfield{ n_blocks };
+            for (auto const& block : client_has_block_)
+            {
+                client_blocks_bitfield_.set(block);
+            }
+
+            return client_blocks_bitfield_;
+        }
+
         [[nodiscard]] bool client_has_piece(tr_piece_index_t piece) const override
         {
             return client_has_piece_.count(piece) != 0;
@@ -69,6 +87,19 @@ protected:
             return block_span_[piece];
         }
 
+        [[nodiscard]] tr_piece_index_t block_piece(tr_block_index_t block) const override
+        {
+            for (auto const& [piece, span] : block_span_)
+            {
+                if (span.begin <= block && block < span.end)
+                {
+                    return piece;
+                }
+            }
+
+            return {};
+        }
+
         [[nodiscard]] tr_piece_index_t piece_count() const override
         {
             return std::size(block_span_);
@@ -307,6 +338,99 @@ TEST_F(PeerMgrWishlistTest, doesNotRequestSameBlockTwice)
     EXPECT_EQ(240U, requested.count(10, 250));
 }
 
+TEST_F(PeerMgrWishlistTest, straddlingBlockIsCreditedBackToEveryCandidate)
+{
+    auto mediator = MockMediator{ *this };
+
+    // setup: two pieces whose boundary falls inside block 10,
+    // so that block belongs to both pieces' spans
+    mediator.block_span_[0] = { 0, 11 };
+    mediator.block_span_[1] = { 10, 20 };
+
+    // peer has all pieces
+    mediator.piece_replication_[0] = 1;
+    mediator.piece_replication_[1] = 1;
+
+    // we want both pieces but already have piece 0, so the only
+    // candidate is piece 1 and block 10 is reachable only through it
+    mediator.client_wants_piece_.insert(0);
+    mediator.client_wants_piece_.insert(1);
+    mediator.client_has_piece_.insert(0);
+
+    // allow the wishlist to build its cache
+    auto wishlist = Wishlist{ mediator };
+
+    // request piece 1's whole span, then watch every block get rejected.
+    // the debit covered block 10, so the credit must cover it too even
+    // though the block's first byte lies in piece 0
+    sent_request_.emit(nullptr, nullptr, { 10, 20 });
+    for (tr_block_index_t block = 10; block < 20; ++block)
+    {
+        got_reject_.emit(nullptr, nullptr, block);
+    }
+
+    // re-request everything but the straddling block
+    sent_request_.emit(nullptr, nullptr, { 11, 20 });
+
+    // block 10 is the piece's one unrequested block; if the credits
+    // above missed it, the candidate's count is stuck at zero and the
+    // first pass skips the piece entirely
+    auto const spans = wishlist.next(20, PeerHasAllPieces);
+    auto requested = tr_bitfield{ 20 };
+    for (auto const& [begin, end] : spans)
+    {
+        requested.set_span(begin, end);
+    }
+    EXPECT_EQ(1U, requested.count());
+    EXPECT_TRUE(requested.test(10));
+}
+
+TEST_F(PeerMgrWishlistTest, endgameSeesBlocksPastAllocatedBitfieldPrefix)
+{
+    auto mediator = MockMediator{ *this };
+
+    // setup: three pieces, all missing
+    mediator.block_span_[0] = { 0, 100 };
+    mediator.block_span_[1] = { 100, 200 };
+    mediator.block_span_[2] = { 200, 250 };
+
+    // peer has all pieces
+    mediator.piece_replication_[0] = 1;
+    mediator.piece_replication_[1] = 1;
+    mediator.piece_replication_[2] = 1;
+
+    // and we want all three pieces
+    mediator.client_wants_piece_.insert(0);
+    mediator.client_wants_piece_.insert(1);
+    mediator.client_wants_piece_.insert(2);
+
+    // the client only has blocks [0..10), so the completion bitfield's
+    // lazily-allocated byte array only covers the low bits; every block
+    // past the allocated prefix is implicitly unset
+    for (tr_block_index_t block = 0; block < 10; ++block)
+    {
+        mediator.client_has_block_.insert(block);
+    }
+
+    // allow the wishlist to build its cache
+    auto wishlist = Wishlist{ mediator };
+
+    // every block is already in flight, which forces the endgame pass
+    sent_request_.emit(nullptr, nullptr, { 0, 250 });
+
+    // endgame must re-request all the blocks we don't have yet,
+    // including those beyond the bitfield's allocated prefix
+    auto const spans = wishlist.next(250, PeerHasAllPieces);
+    auto requested = tr_bitfield{ 250 };
+    for (auto const& [begin, end] : spans)
+    {
+        requested.set_span(begin, end);
+    }
+    EXPECT_EQ(240U, requested.count());
+    EXPECT_EQ(0U, requested.count(0, 10));
+    EXPECT_EQ(240U, requested.count(10, 250));
+}
+
 TEST_F(PeerMgrWishlistTest, DISABLED_sequentialDownload)
 {
     auto const get_spans = [this](size_t n_wanted)
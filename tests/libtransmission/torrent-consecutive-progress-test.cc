@@ -0,0 +1,57 @@
+// This file Copyright © Mnemosyne LLC.
+// It may be used under GPLv2 (SPDX: GPL-2.0-only), GPLv3 (SPDX: GPL-3.0-only),
+// or any future license endorsed by Mnemosyne LLC.
+// License text can be found in the licenses/ folder.
+
+#include <cstdint>
+
+#include <libtransmission/transmission.h>
+
+#include <libtransmission/file.h> // tr_sys_file_*()
+#include <libtransmission/torrent.h>
+#include <libtransmission/tr-strbuf.h>
+
+#include "gtest/gtest.h"
+#include "test-fixtures.h"
+
+namespace libtransmission::test
+{
+
+using TorrentConsecutiveProgressTest = SessionTest;
+
+TEST_F(TorrentConsecutiveProgressTest, fileBeyondAllocatedBitfieldPrefixReportsZeroProgress)
+{
+    auto* const tor = zeroTorrentInit(ZeroTorrentState::NoFiles);
+
+    // create the first file (all zeroes), but not the other two
+    auto const filename = tr_pathbuf{ tor->current_dir(), '/', tr_torrentFile(tor, 0).name };
+    auto dirname = tr_pathbuf{ filename.sv() };
+    dirname.popdir();
+    tr_sys_dir_create(dirname, TR_SYS_DIR_CREATE_PARENTS, 0700);
+    auto const fd = tr_sys_file_open(filename, TR_SYS_FILE_WRITE | TR_SYS_FILE_CREATE | TR_SYS_FILE_TRUNCATE, 0600);
+    auto constexpr Zero = char{ '\0' };
+    for (uint64_t i = 0, n = tr_torrentFile(tor, 0).length; i < n; ++i)
+    {
+        tr_sys_file_write(fd, &Zero, 1, nullptr);
+    }
+    tr_sys_file_close(fd);
+    sync();
+
+    blockingTorrentVerify(tor);
+
+    // only the first file's pieces verify complete, so the completion
+    // bitfield's flags are allocated just up to that file's last block.
+    // The piece holding files 1 and 2 lies entirely past the allocated
+    // prefix; its blocks are implicitly unset, not complete.
+    EXPECT_FLOAT_EQ(1.0F, tor->file_consecutive_progress(0));
+    EXPECT_FLOAT_EQ(0.0F, tor->file_consecutive_progress(1));
+    EXPECT_FLOAT_EQ(0.0F, tor->file_consecutive_progress(2));
+
+    // the counts are cached after the first query; a second query must
+    // not latch a different answer
+    EXPECT_FLOAT_EQ(1.0F, tor->file_consecutive_progress(0));
+    EXPECT_FLOAT_EQ(0.0F, tor->file_consecutive_progress(1));
+    EXPECT_FLOAT_EQ(0.0F, tor->file_consecutive_progress(2));
+}
+
+} // namespace libtransmission::test